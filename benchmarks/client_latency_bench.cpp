@@ -0,0 +1,127 @@
+// client_latency_bench.cpp
+// Order entry round trips through LobClient against a gateway and matching
+// engine in this process, over loopback TCP. Each mode submits resting orders
+// and cancels them again, one request in flight (ping-pong) or a window of
+// them (pipelined), and reports ack latency from the request being queued to
+// its ack being handled, plus the gateway's own share from the ack timestamps.
+#include "../lobClient.hpp"
+#include "../latencyHistogram.hpp"
+#include "../matchingEngine.hpp"
+#include "../simple_server.hpp"
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <thread>
+#include <unordered_map>
+
+namespace {
+
+int64_t now_ns() {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::system_clock::now().time_since_epoch()).count();
+}
+
+struct Result {
+    LatencyHistogram roundTrip;     // request queued -> ack handled
+    LatencyHistogram gateway;       // gateway received -> gateway sent
+    double requestsPerSecond = 0.0;
+    size_t rejected = 0;
+};
+
+void run(LobClient::Mode mode, int port, size_t count, size_t window, Result& result) {
+    LobClient client(mode);
+    if (!client.connect("127.0.0.1", port)) return;
+    client.set_timestamps(true);
+
+    std::unordered_map<uint64_t, int64_t> sentAt;
+    sentAt.reserve(window * 4);
+    std::vector<uint64_t> toCancel;
+    client.on_ack([&](const OrderAck& ack) {
+        int64_t handled = now_ns();
+        auto it = sentAt.find(ack.requestId);
+        if (it != sentAt.end()) {
+            result.roundTrip.record(handled - it->second);
+            sentAt.erase(it);
+        }
+        if (ack.ts[0] > 0 && ack.ts[3] > 0) {
+            result.gateway.record(ack.ts[3] - ack.ts[0]);
+        }
+        if (!ack.accepted) {
+            result.rejected++;
+        } else if (ack.kind == OrderAck::SUBMITTED) {
+            toCancel.push_back(ack.requestId);
+        }
+    });
+
+    auto start = std::chrono::steady_clock::now();
+    size_t submitted = 0;
+    size_t requests = 0;
+    while (submitted < count || client.outstanding() > 0 || !toCancel.empty()) {
+        // Cancels first so the book stays a few orders deep
+        for (uint64_t order : toCancel) {
+            sentAt[client.cancel(order)] = now_ns();
+            requests++;
+        }
+        toCancel.clear();
+        while (submitted < count && client.outstanding() < window) {
+            double price = 99.0 - static_cast<double>(submitted % 50) * 0.01;
+            sentAt[client.submit(BUY, price, 10)] = now_ns();
+            submitted++;
+            requests++;
+        }
+        if (client.poll(-1) < 0) break;
+    }
+    auto elapsed = std::chrono::steady_clock::now() - start;
+    result.requestsPerSecond = requests / std::chrono::duration<double>(elapsed).count();
+}
+
+void report(const char* name, const Result& result) {
+    std::printf("  %-22s %8.0f req/s  rtt p50 %7lld p99 %7lld p99.9 %8lld max %8lld ns  gateway p50 %6lld ns%s\n",
+                name, result.requestsPerSecond,
+                (long long)result.roundTrip.percentile(0.50), (long long)result.roundTrip.percentile(0.99),
+                (long long)result.roundTrip.percentile(0.999), (long long)result.roundTrip.max(),
+                (long long)result.gateway.percentile(0.50), result.rejected ? "  (rejects!)" : "");
+}
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+    size_t count = (argc > 1) ? std::strtoul(argv[1], nullptr, 10) : 20000;
+    size_t window = (argc > 2) ? std::strtoul(argv[2], nullptr, 10) : 32;
+    int port = (argc > 3) ? std::atoi(argv[3]) : 18080;
+
+    MatchingEngine engine;
+    SimpleServer server;
+    server.set_matching_engine_callback([&engine](OrderType type, double price, int quantity,
+                                                  const std::string& symbol, uint32_t symbolId,
+                                                  const std::string& clientId) {
+        return engine.submit_order(type, price, quantity, symbol, symbolId, clientId);
+    });
+    server.set_cancel_callback([&engine](const std::string& orderId) {
+        return engine.cancel_order(orderId);
+    });
+    server.set_modify_callback([&engine](const std::string& orderId, double price, int quantity) {
+        return engine.modify_order(orderId, price, quantity);
+    });
+    if (!server.start(port)) return 1;
+    std::thread gateway([&server]() { server.run(); });
+
+    std::printf("%zu orders submitted and cancelled per mode, pipelined window %zu\n", count, window);
+    struct Mode {
+        const char* name;
+        LobClient::Mode mode;
+        size_t window;
+    };
+    for (const Mode& mode : {Mode{"blocking ping-pong", LobClient::BLOCKING, 1},
+                             Mode{"busy-poll ping-pong", LobClient::BUSY_POLL, 1},
+                             Mode{"blocking pipelined", LobClient::BLOCKING, window},
+                             Mode{"busy-poll pipelined", LobClient::BUSY_POLL, window}}) {
+        Result result;
+        run(mode.mode, port, count, mode.window, result);
+        report(mode.name, result);
+    }
+
+    server.stop();
+    gateway.join();
+    return 0;
+}
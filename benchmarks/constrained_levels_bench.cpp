@@ -0,0 +1,84 @@
+// constrained_levels_bench.cpp
+// Plain FIFO order flow with and without all-or-none / minimum-quantity orders
+// resting in the same levels. Constrained orders sit beside the FIFO queues, so
+// plain sweeps should cost the same either way.
+#include "../matchingEngine.hpp"
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+#include <string>
+#include <vector>
+
+namespace {
+
+struct FlowOrder {
+    OrderType side;
+    double price;
+    int quantity;
+};
+
+std::vector<FlowOrder> make_flow(size_t count, uint64_t seed) {
+    std::mt19937_64 rng(seed);
+    std::uniform_int_distribution<int> ticks(-50, 50);
+    std::uniform_int_distribution<int> size(1, 100);
+    std::vector<FlowOrder> flow;
+    flow.reserve(count);
+    for (size_t i = 0; i < count; ++i) {
+        OrderType side = (rng() & 1) ? BUY : SELL;
+        // Buys lean up and sells lean down so about half the flow crosses
+        int offset = ticks(rng) + ((side == BUY) ? 10 : -10);
+        flow.push_back({side, 100.0 + offset * 0.01, size(rng)});
+    }
+    return flow;
+}
+
+// Constrained orders too large for any flow order to trade with, on every level
+// around the touch, so the sweep passes them at every price it visits
+void seed_constrained(MatchingEngine& engine, int perLevel) {
+    for (int tick = -60; tick <= 60; ++tick) {
+        double price = 100.0 + tick * 0.01;
+        for (int i = 0; i < perLevel; ++i) {
+            bool allOrNone = (i % 2 == 0);
+            int quantity = 10000 + i;
+            engine.submit_constrained_order((tick < 0) ? BUY : SELL, price, quantity,
+                                            allOrNone ? 0 : 5000, allOrNone);
+        }
+    }
+}
+
+double run(const std::vector<FlowOrder>& flow, int constrainedPerLevel, size_t& trades) {
+    MatchingEngine engine;
+    trades = 0;
+    engine.set_execution_callback([&trades](const ExecutionReport& report) {
+        trades += report.fills.size();
+    });
+    if (constrainedPerLevel > 0) seed_constrained(engine, constrainedPerLevel);
+
+    auto start = std::chrono::steady_clock::now();
+    for (const auto& order : flow) {
+        engine.submit_order(order.side, order.price, order.quantity);
+    }
+    auto elapsed = std::chrono::steady_clock::now() - start;
+    return std::chrono::duration<double, std::nano>(elapsed).count() / flow.size();
+}
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+    size_t count = (argc > 1) ? std::strtoul(argv[1], nullptr, 10) : 500000;
+    int rounds = (argc > 2) ? std::atoi(argv[2]) : 3;
+    std::vector<FlowOrder> flow = make_flow(count, 42);
+
+    std::printf("%zu plain orders, best of %d rounds\n", count, rounds);
+    for (int perLevel : {0, 10, 100}) {
+        double best = 0.0;
+        size_t trades = 0;
+        for (int round = 0; round < rounds; ++round) {
+            double nsPerOrder = run(flow, perLevel, trades);
+            if (round == 0 || nsPerOrder < best) best = nsPerOrder;
+        }
+        std::printf("  constrained per level %4d: %8.1f ns/order, %zu fills\n", perLevel, best, trades);
+    }
+    return 0;
+}
@@ -0,0 +1,128 @@
+// shard_batch_bench.cpp
+// One shard owning many symbols, each with a few levels of depth, fed a random
+// mix of passive orders, small aggressive orders and cancels spread over all
+// symbols, so nearly every command lands on a cold book. Compares shard
+// throughput one command at a time against interleaved batch windows.
+//
+// The timed commands are queued while the shard is stopped and the clock runs
+// from restarting it until the last reply, so the shard always finds a full
+// window and the gateway's enqueue cost and ring ping-pong stay out of the number.
+#include "../shardedEngine.hpp"
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace {
+
+struct Resting {
+    uint32_t symbol;
+    std::string orderId;
+};
+
+double run(size_t window, size_t symbolCount, size_t commands, bool slotIds) {
+    // The ring holds every timed command at once
+    ShardedEngine engine(1, nullptr, 0.0, commands);
+    engine.set_batch_window(window);
+    engine.set_slot_order_ids(slotIds);
+
+    std::vector<std::string> symbols;
+    for (size_t i = 0; i < symbolCount; ++i) {
+        symbols.push_back("SYM" + std::to_string(i));
+    }
+
+    std::vector<uint32_t> requestSymbol;
+    std::vector<Resting> resting;
+    size_t acks = 0;
+    engine.set_order_callback([&](const ShardedEngine::OrderResult& result) {
+        acks++;
+        if (result.accepted && result.requestId < requestSymbol.size() && requestSymbol[result.requestId] != UINT32_MAX) {
+            resting.push_back({requestSymbol[result.requestId], result.orderId});
+        }
+    });
+    engine.start();
+
+    // Depth: 10 levels a side, 4 orders each, per symbol
+    requestSymbol.assign(1, UINT32_MAX);
+    for (uint32_t s = 0; s < symbolCount; ++s) {
+        for (int level = 1; level <= 10; ++level) {
+            for (int i = 0; i < 4; ++i) {
+                requestSymbol.push_back(s);
+                engine.submit_order(symbols[s], BUY, 100.0 - level * 0.01, 100);
+                requestSymbol.push_back(s);
+                engine.submit_order(symbols[s], SELL, 100.0 + level * 0.01, 100);
+            }
+        }
+    }
+    while (acks < requestSymbol.size() - 1) {
+        engine.poll();
+    }
+
+    std::mt19937_64 rng(7);
+    std::shuffle(resting.begin(), resting.end(), rng);
+    size_t expected = acks;
+    size_t cancelled = 0;
+    engine.stop();
+    for (size_t i = 0; i < commands; ++i) {
+        uint32_t s = rng() % symbolCount;
+        OrderType side = (rng() & 1) ? BUY : SELL;
+        double away = (side == BUY) ? -1.0 : 1.0;
+        switch (rng() % 4) {
+        case 0:
+        case 1:
+            requestSymbol.push_back(UINT32_MAX);
+            engine.submit_order(symbols[s], side, 100.0 + away * (1 + rng() % 10) * 0.01, 10);
+            break;
+        case 2:
+            requestSymbol.push_back(UINT32_MAX);
+            engine.submit_order(symbols[s], side, 100.0 - away * 0.10, 1);
+            break;
+        default:
+            if (cancelled < resting.size()) {
+                const Resting& order = resting[cancelled++];
+                requestSymbol.push_back(UINT32_MAX);
+                engine.cancel_order(symbols[order.symbol], order.orderId);
+            } else {
+                expected--;
+            }
+            break;
+        }
+        expected++;
+    }
+
+    // Replies fit in the outbound ring too, so the gateway sleeps between polls
+    // rather than spin and take cycles from the shard when both share a core
+    auto start = std::chrono::steady_clock::now();
+    engine.start();
+    while (acks < expected) {
+        if (engine.poll() == 0) std::this_thread::sleep_for(std::chrono::microseconds(200));
+    }
+    auto elapsed = std::chrono::steady_clock::now() - start;
+    engine.stop();
+    return std::chrono::duration<double, std::nano>(elapsed).count() / commands;
+}
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+    size_t symbols = (argc > 1) ? std::strtoul(argv[1], nullptr, 10) : 2000;
+    size_t commands = (argc > 2) ? std::strtoul(argv[2], nullptr, 10) : 200000;
+    int rounds = (argc > 3) ? std::atoi(argv[3]) : 3;
+
+    std::printf("%zu symbols on one shard, %zu commands, best of %d rounds\n", symbols, commands, rounds);
+    for (bool slotIds : {false, true}) {
+        for (size_t window : {1, 4, 8, 16, 32}) {
+            double best = 0.0;
+            for (int round = 0; round < rounds; ++round) {
+                double nsPerCommand = run(window, symbols, commands, slotIds);
+                if (round == 0 || nsPerCommand < best) best = nsPerCommand;
+            }
+            std::printf("  %s ids, window %2zu: %8.1f ns/command\n", slotIds ? "slot" : "hash", window, best);
+        }
+    }
+    return 0;
+}
@@ -0,0 +1,251 @@
+// capture_replay.cpp
+// Re-drives a gateway from a session capture (trading_system --capture): one
+// loopback connection per captured session, opened, fed and closed in capture
+// order, either on the original timeline (optionally scaled) or as fast as
+// the gateway accepts the bytes. Responses are read and discarded.
+#include "sessionCapture.hpp"
+#include <algorithm>
+#include <cerrno>
+#include <chrono>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+#include <arpa/inet.h>
+#include <fcntl.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+namespace {
+
+class Replayer {
+public:
+    Replayer(const std::string& replayHost, int replayPort) : host(replayHost), port(replayPort), scratch(65536) {}
+
+    ~Replayer() {
+        for (const auto& entry : sockets) {
+            close(entry.second);
+        }
+    }
+
+    bool open_session(uint64_t session) {
+        int fd = socket(AF_INET, SOCK_STREAM, 0);
+        if (fd < 0) return false;
+
+        struct sockaddr_in address {};
+        address.sin_family = AF_INET;
+        address.sin_port = htons(port);
+        if (inet_pton(AF_INET, host.c_str(), &address.sin_addr) != 1 ||
+            connect(fd, (struct sockaddr*)&address, sizeof(address)) < 0) {
+            close(fd);
+            return false;
+        }
+
+        // Captured reads are sent as they were received, not coalesced
+        int one = 1;
+        setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+        fcntl(fd, F_SETFL, fcntl(fd, F_GETFL) | O_NONBLOCK);
+
+        auto existing = sockets.find(session);
+        if (existing != sockets.end()) close(existing->second);
+        sockets[session] = fd;
+        opened++;
+        return true;
+    }
+
+    void close_session(uint64_t session) {
+        auto it = sockets.find(session);
+        if (it == sockets.end()) return;
+        close(it->second);
+        sockets.erase(it);
+    }
+
+    // False if the session is not connected or the gateway dropped it
+    bool send_data(uint64_t session, const std::string& data) {
+        auto it = sockets.find(session);
+        if (it == sockets.end()) return false;
+
+        int fd = it->second;
+        size_t offset = 0;
+        while (offset < data.size()) {
+            ssize_t sent = send(fd, data.data() + offset, data.size() - offset, MSG_NOSIGNAL);
+            if (sent > 0) {
+                offset += sent;
+                bytesSent += sent;
+            } else if (sent < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) {
+                // Keep reading responses so the gateway never blocks on us
+                drain(100, fd);
+                if (sockets.find(session) == sockets.end()) return false;
+            } else {
+                close_session(session);
+                return false;
+            }
+        }
+        return true;
+    }
+
+    // Reads and discards whatever the gateway has sent, waiting up to timeoutMs
+    // for something to arrive (or for writeFd to become writable)
+    void drain(int timeoutMs, int writeFd = -1) {
+        pollFds.clear();
+        for (const auto& entry : sockets) {
+            short events = POLLIN;
+            if (entry.second == writeFd) events |= POLLOUT;
+            pollFds.push_back({entry.second, events, 0});
+        }
+        if (poll(pollFds.data(), pollFds.size(), timeoutMs) <= 0) return;
+
+        for (const auto& pfd : pollFds) {
+            if (!(pfd.revents & (POLLIN | POLLHUP | POLLERR))) continue;
+            while (true) {
+                ssize_t received = recv(pfd.fd, scratch.data(), scratch.size(), 0);
+                if (received > 0) {
+                    bytesReceived += received;
+                    continue;
+                }
+                if (received == 0 || (errno != EAGAIN && errno != EWOULDBLOCK)) {
+                    drop(pfd.fd);
+                }
+                break;
+            }
+        }
+    }
+
+    size_t get_opened() const { return opened; }
+    size_t get_bytes_sent() const { return bytesSent; }
+    size_t get_bytes_received() const { return bytesReceived; }
+
+private:
+    std::string host;
+    int port;
+    std::unordered_map<uint64_t, int> sockets;    // captured session -> live connection
+    std::vector<struct pollfd> pollFds;
+    std::vector<char> scratch;
+    size_t opened = 0;
+    size_t bytesSent = 0;
+    size_t bytesReceived = 0;
+
+    void drop(int fd) {
+        for (auto it = sockets.begin(); it != sockets.end(); ++it) {
+            if (it->second == fd) {
+                close(fd);
+                sockets.erase(it);
+                return;
+            }
+        }
+    }
+};
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+    std::string capturePath;
+    std::string host = "127.0.0.1";
+    int port = 8080;
+    double speed = 1.0;
+    bool fast = false;
+    int drainMs = 500;
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        if (arg == "--host" && i + 1 < argc) {
+            host = argv[++i];
+        } else if (arg == "--port" && i + 1 < argc) {
+            port = std::stoi(argv[++i]);
+        } else if (arg == "--speed" && i + 1 < argc) {
+            speed = std::stod(argv[++i]);
+        } else if (arg == "--fast") {
+            fast = true;
+        } else if (arg == "--drain-ms" && i + 1 < argc) {
+            drainMs = std::stoi(argv[++i]);
+        } else if (capturePath.empty() && arg.compare(0, 2, "--") != 0) {
+            capturePath = arg;
+        } else {
+            capturePath.clear();
+            break;
+        }
+    }
+    if (capturePath.empty() || speed <= 0) {
+        std::cerr << "Usage: " << argv[0] << " <capture file> [--host ADDR] [--port P]"
+                  << " [--speed X | --fast] [--drain-ms T]" << std::endl;
+        return 1;
+    }
+
+    std::vector<CaptureEvent> events;
+    if (!SessionCapture::read(capturePath, events)) {
+        return 1;
+    }
+    if (events.empty()) {
+        std::cout << "Capture " << capturePath << " has no events" << std::endl;
+        return 0;
+    }
+
+    Replayer replayer(host, port);
+    const int64_t captureStartNs = events.front().timestampNs;
+    const int64_t captureSpanNs = events.back().timestampNs - captureStartNs;
+    size_t failed = 0;
+    int64_t maxLateNs = 0;
+    double totalLateNs = 0.0;
+
+    // Events go out in capture order from this one thread, so the interleaving
+    // across connections is the captured one; waits are spent reading responses
+    auto start = std::chrono::steady_clock::now();
+    for (const CaptureEvent& event : events) {
+        if (!fast) {
+            auto due = start + std::chrono::nanoseconds(
+                static_cast<int64_t>((event.timestampNs - captureStartNs) / speed));
+            while (true) {
+                auto now = std::chrono::steady_clock::now();
+                if (now >= due) {
+                    int64_t lateNs = std::chrono::duration_cast<std::chrono::nanoseconds>(now - due).count();
+                    maxLateNs = std::max(maxLateNs, lateNs);
+                    totalLateNs += lateNs;
+                    break;
+                }
+                auto waitMs = std::chrono::duration_cast<std::chrono::milliseconds>(due - now).count();
+                if (waitMs > 1) {
+                    replayer.drain(static_cast<int>(waitMs - 1));
+                } else {
+                    std::this_thread::yield();
+                }
+            }
+        }
+
+        bool ok = true;
+        switch (event.type) {
+        case CAPTURE_OPEN:
+            ok = replayer.open_session(event.session);
+            break;
+        case CAPTURE_DATA:
+            ok = replayer.send_data(event.session, event.data);
+            break;
+        case CAPTURE_CLOSE:
+            replayer.close_session(event.session);
+            break;
+        }
+        if (!ok) failed++;
+        replayer.drain(0);
+    }
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    // Let the last responses arrive before hanging up
+    auto drainUntil = std::chrono::steady_clock::now() + std::chrono::milliseconds(drainMs);
+    while (std::chrono::steady_clock::now() < drainUntil) {
+        replayer.drain(10);
+    }
+
+    std::cout << "Replayed " << events.size() << " events from " << replayer.get_opened() << " sessions to "
+              << host << ":" << port << " in " << std::fixed << std::setprecision(3) << seconds
+              << "s (captured span " << captureSpanNs / 1e9 << "s): " << replayer.get_bytes_sent()
+              << " bytes sent, " << replayer.get_bytes_received() << " bytes received, " << failed
+              << " events failed" << std::endl;
+    if (!fast) {
+        std::cout << "Schedule slip: max " << std::setprecision(1) << maxLateNs / 1e3 << "us, mean "
+                  << totalLateNs / events.size() / 1e3 << "us" << std::endl;
+    }
+    return failed == 0 ? 0 : 2;
+}
@@ -0,0 +1,56 @@
+// clientSession.cpp
+#include "clientSession.hpp"
+#include <functional>
+
+ClOrdIdTable::ClOrdIdTable(size_t initialCapacity) : count(0) {
+    size_t capacity = 16;
+    while (capacity < initialCapacity) capacity <<= 1;
+    slots.resize(capacity);
+    mask = capacity - 1;
+}
+
+size_t ClOrdIdTable::probe(const std::string& clOrdId, uint64_t hash) const {
+    size_t index = hash & mask;
+    while (!slots[index].clOrdId.empty() &&
+           (slots[index].hash != hash || slots[index].clOrdId != clOrdId)) {
+        index = (index + 1) & mask;
+    }
+    return index;
+}
+
+const ClOrdIdTable::Entry* ClOrdIdTable::find(const std::string& clOrdId) const {
+    uint64_t hash = std::hash<std::string>()(clOrdId);
+    const Entry& slot = slots[probe(clOrdId, hash)];
+    return slot.clOrdId.empty() ? nullptr : &slot;
+}
+
+const ClOrdIdTable::Entry& ClOrdIdTable::insert(const std::string& clOrdId, const std::string& orderId,
+                                                const std::string& ack) {
+    if ((count + 1) * 2 > slots.size()) {
+        grow();
+    }
+
+    uint64_t hash = std::hash<std::string>()(clOrdId);
+    Entry& slot = slots[probe(clOrdId, hash)];
+    slot.hash = hash;
+    slot.clOrdId = clOrdId;
+    slot.orderId = orderId;
+    slot.ack = ack;
+    count++;
+    return slot;
+}
+
+void ClOrdIdTable::grow() {
+    std::vector<Entry> old(slots.size() * 2);
+    old.swap(slots);
+    mask = slots.size() - 1;
+
+    for (auto& entry : old) {
+        if (entry.clOrdId.empty()) continue;
+        size_t index = entry.hash & mask;
+        while (!slots[index].clOrdId.empty()) {
+            index = (index + 1) & mask;
+        }
+        slots[index] = std::move(entry);
+    }
+}
@@ -0,0 +1,81 @@
+// clientSession.hpp
+#ifndef CLIENTSESSION_HPP
+#define CLIENTSESSION_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <mutex>
+#include <string>
+#include <vector>
+
+// Client order IDs (ClOrdIDs) seen on one session, mapped to the engine order
+// ID and the ack that was sent for them. Open addressing with linear probing
+// over a power-of-two table kept at most half full, so lookups are O(1) and
+// a resend never reaches the matcher. Entries live as long as the session.
+class ClOrdIdTable {
+public:
+    struct Entry {
+        uint64_t hash = 0;
+        std::string clOrdId;    // empty marks a free slot
+        std::string orderId;    // empty if the order was rejected
+        std::string ack;
+    };
+
+    explicit ClOrdIdTable(size_t initialCapacity = 64);
+
+    const Entry* find(const std::string& clOrdId) const;
+    // clOrdId must not be in the table yet
+    const Entry& insert(const std::string& clOrdId, const std::string& orderId, const std::string& ack);
+
+    size_t size() const { return count; }
+
+private:
+    std::vector<Entry> slots;
+    size_t count;
+    size_t mask;
+
+    size_t probe(const std::string& clOrdId, uint64_t hash) const;
+    void grow();
+};
+
+// A response sent with a kernel transmit timestamp requested, waiting for the
+// timestamp to come back on the socket's error queue
+struct PendingTxStamp {
+    int64_t kernelRxNs;         // request reached the socket
+    int64_t userRxNs;           // recv() returned it
+    int64_t sendNs;             // response handed to send()
+    uint32_t lastByte;          // stream offset of its last byte, as echoed in ee_data
+};
+
+// Per-connection gateway state, owned by the connection's thread
+struct ClientSession {
+    int socket;
+    uint64_t id;                // unique per gateway run, used by session capture
+    std::string inbound;        // bytes received after the last complete message
+    ClOrdIdTable orders;
+    std::string symbol;         // of the last order, and its resolved ID
+    uint32_t symbolId = UINT32_MAX;
+
+    // Kernel timestamping (SO_TIMESTAMPING, Linux only). Receive times are of
+    // the last recv(). Transmit stamps carry the stream offset of the stamped
+    // send's last byte, so every thread writing to the socket does so under
+    // sendMutex and counts its bytes in bytesSent.
+    bool kernelTimestamps = false;
+    int64_t kernelRxNs = 0;
+    int64_t userRxNs = 0;
+    std::deque<PendingTxStamp> pendingTx;
+    std::mutex sendMutex;
+    uint64_t bytesSent = 0;
+
+    // Opt-in latency breakdown on acks and fills (set_timestamps); the request
+    // being handled was handed to the engine at sequencedNs, which returned at
+    // matchedNs
+    bool ackTimestamps = false;
+    int64_t sequencedNs = 0;
+    int64_t matchedNs = 0;
+
+    explicit ClientSession(int clientSocket, uint64_t sessionId = 0) : socket(clientSocket), id(sessionId) {}
+};
+
+#endif
@@ -8,16 +8,74 @@
 #include <algorithm>
 #include <iomanip>
 #include <ctime>
+#include <charconv>
+#include <cstdlib>
+#include <cstring>
+#include <cerrno>
+#include <filesystem>
+#include <iterator>
+#include <fcntl.h>
+#include <poll.h>
+#include <unistd.h>
+#include <sys/stat.h>
+#ifdef __linux__
+#include <sys/eventfd.h>
+#include <sys/inotify.h>
+#endif
+
+namespace {
+
+std::string_view trim(std::string_view value) {
+    while (!value.empty() && (value.front() == ' ' || value.front() == '\t')) value.remove_prefix(1);
+    while (!value.empty() && (value.back() == ' ' || value.back() == '\t' || value.back() == '\r')) value.remove_suffix(1);
+    return value;
+}
+
+bool parse_double(std::string_view text, double& value) {
+    char buffer[64];
+    text = trim(text);
+    if (text.empty() || text.size() >= sizeof(buffer)) return false;
+    std::memcpy(buffer, text.data(), text.size());
+    buffer[text.size()] = '\0';
+    char* end = nullptr;
+    value = std::strtod(buffer, &end);
+    return end == buffer + text.size();
+}
+
+bool parse_int(std::string_view text, int& value) {
+    text = trim(text);
+    auto result = std::from_chars(text.data(), text.data() + text.size(), value);
+    return result.ec == std::errc() && result.ptr == text.data() + text.size();
+}
+
+// Raw text of a JSON value: up to the next ',' or '}', or the contents of a string
+std::string_view json_value(std::string_view line, std::string_view key) {
+    size_t pos = line.find(key);
+    if (pos == std::string_view::npos) return {};
+    pos = line.find(':', pos + key.size());
+    if (pos == std::string_view::npos) return {};
+    
+    std::string_view rest = trim(line.substr(pos + 1));
+    if (!rest.empty() && rest.front() == '"') {
+        size_t end = rest.find('"', 1);
+        return (end == std::string_view::npos) ? std::string_view() : rest.substr(1, end - 1);
+    }
+    return rest.substr(0, rest.find_first_of(",}"));
+}
+
+bool has_extension(const std::string& filename, const std::string& extension) {
+    size_t dot = filename.find_last_of('.');
+    return dot != std::string::npos && filename.compare(dot + 1, std::string::npos, extension) == 0;
+}
+
+} // namespace
 
 DataInterface::DataInterface(MatchingEngine& engine) 
-    : matchingEngine(engine), simulationRunning(false) {
-    // Set up trade callback
-    matchingEngine.set_trade_callback([this](const Trade& trade) {
-        on_trade_executed(trade);
-    });
+    : matchingEngine(engine), simulationRunning(false), following(false) {
 }
 
 DataInterface::~DataInterface() {
+    stop_follow();
     stop_simulation();
 }
 
@@ -50,7 +108,10 @@ bool DataInterface::load_orders_from_csv(const std::string& filename) {
     file.close();
     
     // Process all orders
-    matchingEngine.process_orders_batch(orders);
+    {
+        auto engineLock = lock_engine();
+        matchingEngine.process_orders_batch(orders);
+    }
     
     std::cout << "Loaded " << orders.size() << " orders from " << filename << std::endl;
     return true;
@@ -74,7 +135,10 @@ bool DataInterface::load_orders_from_json(const std::string& filename) {
     file.close();
     
     // Process all orders
-    matchingEngine.process_orders_batch(orders);
+    {
+        auto engineLock = lock_engine();
+        matchingEngine.process_orders_batch(orders);
+    }
     
     std::cout << "Loaded " << orders.size() << " orders from " << filename << std::endl;
     return true;
@@ -86,6 +150,9 @@ void DataInterface::start_market_data_simulation(const std::string& symbol, doub
         return;
     }
     
+    if (simulationThread.joinable()) {
+        simulationThread.join(); // a previous run that finished on its own
+    }
     simulationRunning = true;
     simulationThread = std::thread(&DataInterface::simulation_worker, this, symbol, basePrice, numOrders);
     
@@ -94,11 +161,14 @@ void DataInterface::start_market_data_simulation(const std::string& symbol, doub
 }
 
 void DataInterface::stop_simulation() {
-    if (simulationRunning) {
-        simulationRunning = false;
-        if (simulationThread.joinable()) {
-            simulationThread.join();
-        }
+    // The worker clears simulationRunning itself when it runs out of orders,
+    // but its thread still has to be joined
+    bool wasRunning = simulationRunning;
+    simulationRunning = false;
+    if (simulationThread.joinable()) {
+        simulationThread.join();
+    }
+    if (wasRunning) {
         std::cout << "Market data simulation stopped" << std::endl;
     }
 }
@@ -120,10 +190,9 @@ void DataInterface::print_statistics() const {
     std::cout << "Total Volume: " << std::fixed << std::setprecision(2) << totalVolume << std::endl;
     std::cout << "Average Trade Size: " << (totalTrades > 0 ? totalVolume / totalTrades : 0.0) << std::endl;
     
-    if (!tradeHistory.empty()) {
-        auto latestTrade = tradeHistory.back();
-        std::cout << "Latest Trade: " << latestTrade.quantity << " @ " 
-                  << std::fixed << std::setprecision(2) << latestTrade.price << std::endl;
+    if (totalTrades > 0) {
+        std::cout << "Latest Trade: " << lastTradeQuantity << " @ " 
+                  << std::fixed << std::setprecision(2) << lastTradePrice << std::endl;
     }
     
     std::cout << "Best Bid: " << std::fixed << std::setprecision(2) << matchingEngine.get_best_bid() << std::endl;
@@ -164,7 +233,10 @@ void DataInterface::simulation_worker(const std::string& symbol, double basePric
         price = std::round(price * 100.0) / 100.0;
         
         // Submit order
-        std::string orderId = matchingEngine.submit_order(type, price, quantity, symbol);
+        {
+            auto engineLock = lock_engine();
+            matchingEngine.submit_order(type, price, quantity, symbol);
+        }
         
         // Small delay to simulate real-time data
         std::this_thread::sleep_for(std::chrono::milliseconds(10));
@@ -173,111 +245,492 @@ void DataInterface::simulation_worker(const std::string& symbol, double basePric
     simulationRunning = false;
 }
 
+std::unique_lock<std::mutex> DataInterface::lock_engine() {
+    return engineMutex ? std::unique_lock<std::mutex>(*engineMutex) : std::unique_lock<std::mutex>();
+}
+
 void DataInterface::process_order_queue() {
-    while (simulationRunning) {
-        std::unique_lock<std::mutex> lock(queueMutex);
-        queueCondition.wait(lock, [this] { return !orderQueue.empty() || !simulationRunning; });
+    // Offsets are persisted at most every 100ms; stop_follow() saves the final ones
+    auto lastSave = std::chrono::steady_clock::now();
+    std::unique_lock<std::mutex> lock(queueMutex);
+    while (true) {
+        queueCondition.wait(lock, [this] { return !orderQueue.empty() || !ingressRunning; });
+        if (orderQueue.empty() && !ingressRunning) break;
+        
+        // Take everything queued so far and match it without holding the lock
+        std::queue<IngressBatch> batches;
+        batches.swap(orderQueue);
+        lock.unlock();
+        
+        std::vector<std::pair<size_t, uint64_t>> consumed;
+        {
+            auto engineLock = lock_engine();
+            while (!batches.empty()) {
+                const IngressBatch& batch = batches.front();
+                for (const auto& order : batch.orders) {
+                    matchingEngine.submit_order(order->type, order->price, order->quantity,
+                                                order->symbol, order->clientId);
+                }
+                consumed.emplace_back(batch.file, batch.endOffset);
+                batches.pop();
+            }
+        }
         
-        while (!orderQueue.empty()) {
-            auto order = orderQueue.front();
-            orderQueue.pop();
+        lock.lock();
+        for (const auto& entry : consumed) {
+            followedFiles[entry.first].submitted = entry.second;
+        }
+        auto now = std::chrono::steady_clock::now();
+        if (now - lastSave >= std::chrono::milliseconds(100)) {
             lock.unlock();
-            
-            // Process order through matching engine
-            // This would be implemented based on your specific needs
-            
+            save_follow_offsets();
+            lastSave = now;
             lock.lock();
         }
     }
 }
 
-std::shared_ptr<Order> DataInterface::parse_csv_line(const std::string& line) {
-    std::istringstream iss(line);
-    std::string token;
-    std::vector<std::string> tokens;
-    
-    while (std::getline(iss, token, ',')) {
-        tokens.push_back(token);
+bool DataInterface::parse_csv_fields(std::string_view line, ParsedOrder& out) {
+    std::string_view fields[5];
+    size_t count = 0;
+    while (count < 5) {
+        size_t comma = line.find(',');
+        fields[count++] = line.substr(0, comma);
+        if (comma == std::string_view::npos) break;
+        line.remove_prefix(comma + 1);
     }
+    if (count < 3) return false;
+    
+    std::string_view type = trim(fields[0]);
+    out.type = (type == "BUY" || type == "buy") ? BUY : SELL;
+    if (!parse_double(fields[1], out.price) || !parse_int(fields[2], out.quantity)) return false;
+    out.symbol = (count > 3) ? trim(fields[3]) : std::string_view("DEFAULT");
+    out.clientId = (count > 4) ? trim(fields[4]) : std::string_view("CSV_CLIENT");
+    return true;
+}
+
+bool DataInterface::parse_json_fields(std::string_view line, ParsedOrder& out) {
+    // Expected format: {"type":"BUY","price":100.0,"quantity":10,"symbol":"AAPL"}
+    if (line.find("\"type\"") == std::string_view::npos) return false;
     
-    if (tokens.size() < 3) return nullptr;
+    out.type = (json_value(line, "\"type\"") == "BUY") ? BUY : SELL;
+    out.price = 0.0;
+    out.quantity = 0;
     
-    try {
-        OrderType type = (tokens[0] == "BUY" || tokens[0] == "buy") ? BUY : SELL;
-        double price = std::stod(tokens[1]);
-        int quantity = std::stoi(tokens[2]);
-        std::string symbol = (tokens.size() > 3) ? tokens[3] : "DEFAULT";
-        std::string clientId = (tokens.size() > 4) ? tokens[4] : "CSV_CLIENT";
-        
-        return std::make_shared<Order>("CSV_" + std::to_string(std::time(nullptr)), 
-                                     type, price, quantity, symbol, clientId);
-    } catch (const std::exception& e) {
-        std::cerr << "Error parsing CSV line: " << line << " - " << e.what() << std::endl;
+    std::string_view price = json_value(line, "\"price\"");
+    if (!price.empty() && !parse_double(price, out.price)) return false;
+    std::string_view quantity = json_value(line, "\"quantity\"");
+    if (!quantity.empty() && !parse_int(quantity, out.quantity)) return false;
+    
+    std::string_view symbol = json_value(line, "\"symbol\"");
+    out.symbol = symbol.empty() ? std::string_view("DEFAULT") : symbol;
+    out.clientId = "JSON_CLIENT";
+    return true;
+}
+
+std::shared_ptr<Order> DataInterface::parse_csv_line(const std::string& line) {
+    ParsedOrder parsed;
+    if (!parse_csv_fields(line, parsed)) {
+        if (std::count(line.begin(), line.end(), ',') >= 2) {
+            std::cerr << "Error parsing CSV line: " << line << std::endl;
+        }
         return nullptr;
     }
+    
+    // The engine assigns the ID
+    return std::make_shared<Order>("", parsed.type, parsed.price, parsed.quantity,
+                                   std::string(parsed.symbol), std::string(parsed.clientId));
 }
 
 std::shared_ptr<Order> DataInterface::parse_json_line(const std::string& line) {
-    // Simple JSON parsing - in production, use a proper JSON library
-    // Expected format: {"type":"BUY","price":100.0,"quantity":10,"symbol":"AAPL"}
-    
     if (line.find("\"type\"") == std::string::npos) return nullptr;
     
-    try {
-        OrderType type = BUY;
-        double price = 0.0;
-        int quantity = 0;
-        std::string symbol = "DEFAULT";
-        
-        // Extract type
-        size_t typePos = line.find("\"type\"");
-        if (typePos != std::string::npos) {
-            size_t valueStart = line.find("\"", typePos + 7) + 1;
-            size_t valueEnd = line.find("\"", valueStart);
-            std::string typeStr = line.substr(valueStart, valueEnd - valueStart);
-            type = (typeStr == "BUY") ? BUY : SELL;
+    ParsedOrder parsed;
+    if (!parse_json_fields(line, parsed)) {
+        std::cerr << "Error parsing JSON line: " << line << std::endl;
+        return nullptr;
+    }
+    
+    // The engine assigns the ID
+    return std::make_shared<Order>("", parsed.type, parsed.price, parsed.quantity,
+                                   std::string(parsed.symbol), std::string(parsed.clientId));
+}
+
+bool DataInterface::start_follow(const std::vector<std::string>& filenames, const std::string& offsetFile) {
+#ifdef __linux__
+    if (following) {
+        std::cout << "Follow mode already running" << std::endl;
+        return false;
+    }
+    
+    inotifyFd = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+    wakeFd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    if (inotifyFd < 0 || wakeFd < 0) {
+        std::cerr << "Error: Could not initialise inotify: " << std::strerror(errno) << std::endl;
+        stop_follow();
+        return false;
+    }
+    
+    for (const auto& filename : filenames) {
+        bool json = has_extension(filename, "json") || has_extension(filename, "jsonl");
+        if (!json && !has_extension(filename, "csv")) {
+            std::cerr << "Unsupported file format for " << filename << ". Use .csv, .json or .jsonl files." << std::endl;
+            stop_follow();
+            return false;
         }
         
-        // Extract price
-        size_t pricePos = line.find("\"price\"");
-        if (pricePos != std::string::npos) {
-            size_t valueStart = line.find(":", pricePos) + 1;
-            size_t valueEnd = line.find_first_of(",}", valueStart);
-            price = std::stod(line.substr(valueStart, valueEnd - valueStart));
+        int fd = open(filename.c_str(), O_RDONLY | O_CLOEXEC);
+        int watch = (fd >= 0) ? inotify_add_watch(inotifyFd, filename.c_str(), IN_MODIFY) : -1;
+        if (watch < 0) {
+            std::cerr << "Error: Could not follow " << filename << ": " << std::strerror(errno) << std::endl;
+            if (fd >= 0) close(fd);
+            stop_follow();
+            return false;
         }
-        
-        // Extract quantity
-        size_t qtyPos = line.find("\"quantity\"");
-        if (qtyPos != std::string::npos) {
-            size_t valueStart = line.find(":", qtyPos) + 1;
-            size_t valueEnd = line.find_first_of(",}", valueStart);
-            quantity = std::stoi(line.substr(valueStart, valueEnd - valueStart));
+        followedFiles.push_back({filename, json, fd, watch, 0, std::string(), 0});
+    }
+    
+    followOffsetFile = offsetFile;
+    load_follow_offsets();
+    
+    {
+        std::lock_guard<std::mutex> lock(queueMutex);
+        ingressRunning = true;
+    }
+    ingressThread = std::thread(&DataInterface::process_order_queue, this);
+    following = true;
+    followThread = std::thread(&DataInterface::follow_worker, this);
+    
+    std::cout << "Following " << followedFiles.size() << " file(s)" << std::endl;
+    return true;
+#else
+    (void)filenames;
+    (void)offsetFile;
+    std::cerr << "Follow mode requires inotify (Linux)" << std::endl;
+    return false;
+#endif
+}
+
+void DataInterface::stop_follow() {
+#ifdef __linux__
+    if (following) {
+        following = false;
+        uint64_t one = 1;
+        if (write(wakeFd, &one, sizeof(one)) < 0) {
+            std::cerr << "Error: Could not wake follow thread" << std::endl;
+        }
+        if (followThread.joinable()) {
+            followThread.join();
         }
+    }
+    
+    // Orders already queued are submitted before the final offsets are saved
+    {
+        std::lock_guard<std::mutex> lock(queueMutex);
+        ingressRunning = false;
+    }
+    queueCondition.notify_one();
+    if (ingressThread.joinable()) {
+        ingressThread.join();
+        save_follow_offsets();
+    }
+    
+    for (auto& file : followedFiles) {
+        close(file.fd);
+    }
+    followedFiles.clear();
+    if (inotifyFd >= 0) close(inotifyFd);
+    if (wakeFd >= 0) close(wakeFd);
+    inotifyFd = -1;
+    wakeFd = -1;
+#endif
+}
+
+void DataInterface::follow_worker() {
+#ifdef __linux__
+    // Catch up on whatever was written before we started watching
+    for (auto& file : followedFiles) {
+        read_appended(file);
+    }
+    
+    alignas(struct inotify_event) char events[4096];
+    std::unordered_map<int, FollowedFile*> byWatch;
+    for (auto& file : followedFiles) {
+        byWatch[file.watch] = &file;
+    }
+    
+    pollfd fds[2] = {{inotifyFd, POLLIN, 0}, {wakeFd, POLLIN, 0}};
+    while (following) {
+        if (poll(fds, 2, -1) < 0) {
+            if (errno == EINTR) continue;
+            std::cerr << "Error: Follow mode poll failed: " << std::strerror(errno) << std::endl;
+            break;
+        }
+        if (fds[1].revents & POLLIN) break;
         
-        // Extract symbol
-        size_t symPos = line.find("\"symbol\"");
-        if (symPos != std::string::npos) {
-            size_t valueStart = line.find("\"", symPos + 9) + 1;
-            size_t valueEnd = line.find("\"", valueStart);
-            symbol = line.substr(valueStart, valueEnd - valueStart);
+        ssize_t length;
+        while ((length = read(inotifyFd, events, sizeof(events))) > 0) {
+            for (char* ptr = events; ptr < events + length; ) {
+                auto* event = reinterpret_cast<struct inotify_event*>(ptr);
+                auto it = byWatch.find(event->wd);
+                if (it != byWatch.end()) {
+                    read_appended(*it->second);
+                }
+                ptr += sizeof(struct inotify_event) + event->len;
+            }
         }
+    }
+#endif
+}
+
+void DataInterface::read_appended(FollowedFile& file) {
+    struct stat st;
+    uint64_t startOffset = file.offset;
+    if (fstat(file.fd, &st) == 0 && static_cast<uint64_t>(st.st_size) < file.offset + file.partial.size()) {
+        std::cerr << "File " << file.path << " was truncated; restarting from the beginning" << std::endl;
+        file.offset = 0;
+        file.partial.clear();
+    }
+    
+    std::vector<std::shared_ptr<Order>> parsed;
+    char buffer[65536];
+    while (true) {
+        ssize_t bytes = pread(file.fd, buffer, sizeof(buffer), file.offset + file.partial.size());
+        if (bytes <= 0) break;
+        file.partial.append(buffer, bytes);
         
-        return std::make_shared<Order>("JSON_" + std::to_string(std::time(nullptr)), 
-                                     type, price, quantity, symbol, "JSON_CLIENT");
-    } catch (const std::exception& e) {
-        std::cerr << "Error parsing JSON line: " << line << " - " << e.what() << std::endl;
-        return nullptr;
+        // Only complete lines are consumed; the tail waits for the rest of its line
+        size_t consumed = 0;
+        size_t newline;
+        while ((newline = file.partial.find('\n', consumed)) != std::string::npos) {
+            std::string_view line(file.partial.data() + consumed, newline - consumed);
+            bool header = (file.offset == 0 && consumed == 0 && !file.json &&
+                           (line.find("type") != std::string_view::npos || line.find("Type") != std::string_view::npos));
+            
+            ParsedOrder order;
+            bool ok = file.json ? parse_json_fields(line, order) : parse_csv_fields(line, order);
+            if (ok && !header) {
+                parsed.push_back(std::make_shared<Order>("", order.type, order.price, order.quantity,
+                                                         std::string(order.symbol), std::string(order.clientId)));
+            } else if (!ok && !trim(line).empty() && !header) {
+                std::cerr << "Error parsing line in " << file.path << ": " << line << std::endl;
+            }
+            consumed = newline + 1;
+        }
+        file.offset += consumed;
+        file.partial.erase(0, consumed);
+    }
+    
+    // Lines that held no order still move the file's offset once the batch is through
+    if (!parsed.empty() || file.offset != startOffset) {
+        {
+            std::lock_guard<std::mutex> lock(queueMutex);
+            orderQueue.push({std::move(parsed), static_cast<size_t>(&file - followedFiles.data()), file.offset});
+        }
+        queueCondition.notify_one();
+    }
+}
+
+void DataInterface::load_follow_offsets() {
+    if (followOffsetFile.empty()) return;
+    
+    std::ifstream file(followOffsetFile);
+    std::string path;
+    uint64_t offset;
+    while (file >> path >> offset) {
+        for (auto& followed : followedFiles) {
+            if (followed.path == path) followed.offset = followed.submitted = offset;
+        }
+    }
+}
+
+void DataInterface::save_follow_offsets() {
+    if (followOffsetFile.empty()) return;
+    
+    std::ostringstream offsets;
+    {
+        std::lock_guard<std::mutex> lock(queueMutex);
+        for (const auto& followed : followedFiles) {
+            offsets << followed.path << " " << followed.submitted << "\n";
+        }
+    }
+    
+    // Write-then-rename so a crash never leaves a half-written offset file
+    std::string tmp = followOffsetFile + ".tmp";
+    {
+        std::ofstream file(tmp, std::ios::trunc);
+        file << offsets.str();
+    }
+    if (std::rename(tmp.c_str(), followOffsetFile.c_str()) != 0) {
+        std::cerr << "Error: Could not save follow offsets to " << followOffsetFile << std::endl;
     }
 }
 
-void DataInterface::on_trade_executed(const Trade& trade) {
+void DataInterface::record_execution(const ExecutionReport& report) {
+    if (report.fills.empty()) return;
+    
     std::lock_guard<std::mutex> lock(statsMutex);
-    totalTrades++;
-    totalVolume += trade.quantity * trade.price;
-    tradeHistory.push_back(trade);
+    totalTrades += report.fills.size();
+    totalVolume += report.averagePrice * report.filledQuantity;
+    lastTradePrice = report.fills.back().price;
+    lastTradeQuantity = report.fills.back().quantity;
+}
+
+void IngestStats::merge(const IngestStats& other) {
+    files += other.files;
+    symbols += other.symbols;
+    orders += other.orders;
+    rejected += other.rejected;
+    parseErrors += other.parseErrors;
+    trades += other.trades;
+    volume += other.volume;
+}
+
+IngestStats DataInterface::ingest_parallel(const std::string& source, unsigned threads, SymbolBooks* books,
+                                           const InstrumentMaster* instruments, double hotWindow, bool slotOrderIds) {
+    auto start = std::chrono::steady_clock::now();
+    IngestStats total;
+    
+    std::vector<std::string> paths;
+    std::error_code ec;
+    if (std::filesystem::is_directory(source, ec)) {
+        for (const auto& entry : std::filesystem::directory_iterator(source, ec)) {
+            if (entry.is_regular_file()) paths.push_back(entry.path().string());
+        }
+    } else {
+        std::ifstream manifest(source);
+        if (!manifest.is_open()) {
+            std::cerr << "Error: Could not open ingest source " << source << std::endl;
+            return total;
+        }
+        std::string line;
+        while (std::getline(manifest, line)) {
+            std::string_view path = trim(line);
+            if (!path.empty() && path.front() != '#') paths.emplace_back(path);
+        }
+    }
+    
+    // Group files by symbol; name order within a symbol is replay order (e.g. AAPL_20240102.csv)
+    struct SymbolGroup {
+        std::string symbol;
+        std::vector<std::string> files;
+        uintmax_t bytes = 0;
+    };
+    std::vector<SymbolGroup> groups;
+    std::unordered_map<std::string, size_t> groupIndex;
+    std::sort(paths.begin(), paths.end());
+    for (const auto& path : paths) {
+        if (!has_extension(path, "csv") && !has_extension(path, "json") && !has_extension(path, "jsonl")) continue;
+        
+        std::string name = std::filesystem::path(path).filename().string();
+        std::string symbol = name.substr(0, name.find_first_of("_."));
+        auto it = groupIndex.emplace(symbol, groups.size()).first;
+        if (it->second == groups.size()) groups.push_back({symbol, {}, 0});
+        
+        SymbolGroup& group = groups[it->second];
+        group.files.push_back(path);
+        group.bytes += std::filesystem::file_size(path, ec);
+    }
+    
+    // Largest symbols first so the tail of the run is made of small ones
+    std::sort(groups.begin(), groups.end(), [](const SymbolGroup& a, const SymbolGroup& b) {
+        return a.bytes > b.bytes;
+    });
+    
+    if (threads == 0) threads = std::max(1u, std::thread::hardware_concurrency());
+    threads = std::min<unsigned>(threads, std::max<size_t>(1, groups.size()));
+    
+    std::atomic<size_t> nextGroup(0);
+    std::vector<IngestStats> workerStats(threads);
+    std::vector<SymbolBooks> workerBooks(threads);
+    auto worker = [&](unsigned id) {
+        IngestStats& stats = workerStats[id];
+        size_t index;
+        while ((index = nextGroup.fetch_add(1)) < groups.size()) {
+            const SymbolGroup& group = groups[index];
+            auto engine = std::make_unique<MatchingEngine>();
+            engine->set_instrument_master(instruments);
+            if (hotWindow > 0) engine->set_hot_window(hotWindow);
+            engine->set_slot_order_ids(slotOrderIds);
+            uint32_t symbolId = engine->symbol_id(group.symbol);
+            engine->set_execution_callback([&stats](const ExecutionReport& report) {
+                stats.trades += report.fills.size();
+                stats.volume += report.filledQuantity * report.averagePrice;
+            });
+            
+            for (const auto& path : group.files) {
+                ingest_file(path, group.symbol, symbolId, *engine, stats);
+            }
+            stats.symbols++;
+            
+            if (books) {
+                workerBooks[id].emplace(group.symbol, std::move(engine));
+            }
+        }
+    };
     
-    // Keep only last 1000 trades to prevent memory growth
-    if (tradeHistory.size() > 1000) {
-        tradeHistory.erase(tradeHistory.begin());
+    std::vector<std::thread> pool;
+    for (unsigned i = 1; i < threads; ++i) {
+        pool.emplace_back(worker, i);
+    }
+    worker(0);
+    for (auto& thread : pool) {
+        thread.join();
+    }
+    
+    for (unsigned i = 0; i < threads; ++i) {
+        total.merge(workerStats[i]);
+        if (books) {
+            for (auto& entry : workerBooks[i]) {
+                (*books)[entry.first] = std::move(entry.second);
+            }
+        }
+    }
+    total.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    return total;
+}
+
+void DataInterface::ingest_file(const std::string& path, const std::string& symbol, uint32_t symbolId,
+                                MatchingEngine& engine, IngestStats& stats) {
+    std::ifstream file(path, std::ios::binary);
+    if (!file.is_open()) {
+        std::cerr << "Error: Could not open file " << path << std::endl;
+        return;
+    }
+    std::string contents((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+    stats.files++;
+    
+    bool json = !has_extension(path, "csv");
+    std::string_view remaining(contents);
+    bool first = true;
+    while (!remaining.empty()) {
+        size_t newline = remaining.find('\n');
+        std::string_view line = remaining.substr(0, newline);
+        remaining.remove_prefix(newline == std::string_view::npos ? remaining.size() : newline + 1);
+        
+        if (first && !json && (line.find("type") != std::string_view::npos || line.find("Type") != std::string_view::npos)) {
+            first = false;
+            continue;
+        }
+        first = false;
+        if (trim(line).empty()) continue;
+        
+        ParsedOrder order;
+        if (!(json ? parse_json_fields(line, order) : parse_csv_fields(line, order))) {
+            stats.parseErrors++;
+            continue;
+        }
+        // Rows without a symbol belong to the file's symbol; the book holds no other
+        if (order.symbol != "DEFAULT" && order.symbol != symbol) {
+            stats.rejected++;
+            continue;
+        }
+        std::string orderId = engine.submit_order(order.type, order.price, order.quantity, symbol, symbolId,
+                                                  std::string(order.clientId));
+        if (orderId.empty()) {
+            stats.rejected++;
+        } else {
+            stats.orders++;
+        }
     }
 }
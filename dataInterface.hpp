@@ -13,6 +13,26 @@
 #include <queue>
 #include <mutex>
 #include <condition_variable>
+#include <string_view>
+#include <memory>
+#include <unordered_map>
+
+// Totals of a parallel ingest, merged from every worker
+struct IngestStats {
+    size_t files = 0;
+    size_t symbols = 0;
+    size_t orders = 0;          // accepted by their book
+    size_t rejected = 0;        // refused by the book, or for another symbol than their file's
+    size_t parseErrors = 0;
+    size_t trades = 0;
+    double volume = 0.0;
+    double seconds = 0.0;
+    
+    void merge(const IngestStats& other);
+};
+
+// Books built by a parallel ingest, one engine per symbol
+using SymbolBooks = std::unordered_map<std::string, std::unique_ptr<MatchingEngine>>;
 
 class DataInterface {
 public:
@@ -30,32 +50,107 @@ public:
     // Manual order input
     void add_manual_order(OrderType type, double price, int quantity, const std::string& symbol = "DEFAULT");
     
-    // Statistics and monitoring
+    // Statistics and monitoring. Fed by whoever owns the engine's execution
+    // callback, one call per execution report.
+    void record_execution(const ExecutionReport& report);
     void print_statistics() const;
     void set_trade_callback(std::function<void(const Trade&)> callback);
     
     // Batch processing
     void process_orders_from_file(const std::string& filename);
+    
+    // Follow mode: ingest complete lines as they are appended to the given .csv/.json(l)
+    // files. Each file resumes from the offset saved in offsetFile, if any; only
+    // offsets of lines whose orders the engine has taken are saved.
+    bool start_follow(const std::vector<std::string>& filenames, const std::string& offsetFile = "");
+    void stop_follow();
+    
+    // Follow mode and the simulation hold this mutex around engine calls, so they
+    // can run alongside other threads (the gateway) that lock it as well
+    void set_engine_mutex(std::mutex* mutex) { engineMutex = mutex; }
+    
+    // Parallel ingest of a directory of .csv/.json(l) files or a manifest listing one path
+    // per line. Files are grouped by symbol (file name up to the first '_' or '.'); each
+    // symbol's files are parsed and matched in name order by one worker into its own book,
+    // so per-symbol ordering is preserved. threads == 0 uses every core. Each book is
+    // configured like the live engine would be (instruments, hot window, slot IDs) and
+    // handed back in books if given. Rows naming another symbol than their file's are
+    // rejected; rows without a symbol belong to the file's.
+    static IngestStats ingest_parallel(const std::string& source, unsigned threads = 0,
+                                       SymbolBooks* books = nullptr, const InstrumentMaster* instruments = nullptr,
+                                       double hotWindow = 0.0, bool slotOrderIds = false);
 
 private:
+    struct ParsedOrder {
+        OrderType type;
+        double price;
+        int quantity;
+        std::string_view symbol;
+        std::string_view clientId;
+    };
+    
+    struct FollowedFile {
+        std::string path;
+        bool json;
+        int fd;
+        int watch;
+        uint64_t offset;        // bytes read through the last complete line
+        std::string partial;    // incomplete trailing line
+        uint64_t submitted;     // through the last line the engine has taken; under queueMutex
+    };
+    
+    // Orders of the lines of one file read in one go, and how far the file is
+    // consumed once they have been submitted
+    struct IngressBatch {
+        std::vector<std::shared_ptr<Order>> orders;
+        size_t file;
+        uint64_t endOffset;
+    };
+    
     MatchingEngine& matchingEngine;
+    std::mutex* engineMutex = nullptr;
     std::atomic<bool> simulationRunning;
     std::thread simulationThread;
-    std::queue<std::shared_ptr<Order>> orderQueue;
+    
+    // Ingress queue: parsed orders waiting for the matching engine
+    std::queue<IngressBatch> orderQueue;
     std::mutex queueMutex;
     std::condition_variable queueCondition;
+    bool ingressRunning = false;
+    std::thread ingressThread;
+    
+    // Follow mode state, owned by followThread while it runs (except submitted)
+    std::vector<FollowedFile> followedFiles;
+    std::string followOffsetFile;
+    std::atomic<bool> following;
+    std::thread followThread;
+    int inotifyFd = -1;
+    int wakeFd = -1;
     
     // Statistics
     mutable std::mutex statsMutex;
     size_t totalTrades = 0;
     double totalVolume = 0.0;
-    std::vector<Trade> tradeHistory;
+    double lastTradePrice = 0.0;
+    int lastTradeQuantity = 0;
     
     void simulation_worker(const std::string& symbol, double basePrice, int numOrders);
     void process_order_queue();
+    std::unique_lock<std::mutex> lock_engine();
     std::shared_ptr<Order> parse_csv_line(const std::string& line);
     std::shared_ptr<Order> parse_json_line(const std::string& line);
-    void on_trade_executed(const Trade& trade);
+    
+    // Allocation-free field parsers shared by file loading and follow mode
+    static bool parse_csv_fields(std::string_view line, ParsedOrder& out);
+    static bool parse_json_fields(std::string_view line, ParsedOrder& out);
+    
+    void follow_worker();
+    void read_appended(FollowedFile& file);
+    void load_follow_offsets();
+    void save_follow_offsets();
+    
+    static void ingest_file(const std::string& path, const std::string& symbol, uint32_t symbolId,
+                            MatchingEngine& engine, IngestStats& stats);
 };
 
 #endif
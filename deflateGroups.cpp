@@ -0,0 +1,131 @@
+// deflateGroups.cpp
+#include "deflateGroups.hpp"
+#include <cstdlib>
+#include <sstream>
+#include <vector>
+
+namespace {
+
+std::string trim(const std::string& text) {
+    size_t begin = text.find_first_not_of(" \t");
+    if (begin == std::string::npos) return "";
+    size_t end = text.find_last_not_of(" \t");
+    return text.substr(begin, end - begin + 1);
+}
+
+} // namespace
+
+bool DeflateParams::parse(const std::string& extensionsHeader, DeflateParams& params) {
+    std::stringstream extensions(extensionsHeader);
+    std::string extension;
+    while (std::getline(extensions, extension, ',')) {
+        std::stringstream parts(extension);
+        std::string part;
+        if (!std::getline(parts, part, ';') || trim(part) != "permessage-deflate") continue;
+
+        params = DeflateParams();
+        while (std::getline(parts, part, ';')) {
+            part = trim(part);
+            if (part == "server_no_context_takeover") {
+                params.noContextTakeover = true;
+            } else if (part.compare(0, 23, "server_max_window_bits=") == 0) {
+                params.windowBits = std::atoi(part.c_str() + 23);
+            }
+        }
+        // zlib's raw deflate has no 256-byte window
+        return params.windowBits >= 9 && params.windowBits <= 15;
+    }
+    return false;
+}
+
+DeflateGroups::Group::Group(const DeflateParams& deflateParams) : params(deflateParams) {
+    stream = z_stream();
+    if (deflateInit2(&stream, Z_DEFAULT_COMPRESSION, Z_DEFLATED, -params.windowBits, 8, Z_DEFAULT_STRATEGY) != Z_OK) {
+        stream.state = nullptr;
+    }
+}
+
+DeflateGroups::Group::~Group() {
+    if (stream.state) {
+        deflateEnd(&stream);
+    }
+}
+
+DeflateGroups::GroupId DeflateGroups::join(const DeflateParams& params) {
+    GroupId id = nextGroup++;
+    std::unique_ptr<Group> group(new Group(params));
+    group->members = 1;
+    groups.emplace(id, std::move(group));
+    return id;
+}
+
+void DeflateGroups::leave(GroupId id) {
+    auto it = groups.find(id);
+    if (it != groups.end() && --it->second->members == 0) {
+        groups.erase(it);
+    }
+}
+
+std::unordered_map<DeflateGroups::GroupId, DeflateGroups::GroupId> DeflateGroups::merge() {
+    std::unordered_map<GroupId, GroupId> moved;
+    std::vector<GroupId> survivors;
+    for (auto it = groups.begin(); it != groups.end();) {
+        GroupId target = 0;
+        for (GroupId survivor : survivors) {
+            if (groups[survivor]->params == it->second->params) {
+                target = survivor;
+                break;
+            }
+        }
+        if (target == 0) {
+            survivors.push_back(it->first);
+            ++it;
+            continue;
+        }
+        groups[target]->members += it->second->members;
+        moved[it->first] = target;
+        it = groups.erase(it);
+    }
+
+    // Members came from different histories, so the shared compressor starts over
+    for (GroupId survivor : survivors) {
+        Group& group = *groups[survivor];
+        if (group.stream.state) {
+            deflateReset(&group.stream);
+        }
+    }
+    return moved;
+}
+
+const std::string& DeflateGroups::compress(GroupId id, const std::string& message) {
+    output.clear();
+    auto it = groups.find(id);
+    if (it == groups.end() || !it->second->stream.state) return output;
+
+    Group& group = *it->second;
+    if (group.params.noContextTakeover) {
+        deflateReset(&group.stream);
+    }
+
+    z_stream& stream = group.stream;
+    stream.next_in = reinterpret_cast<Bytef*>(const_cast<char*>(message.data()));
+    stream.avail_in = static_cast<uInt>(message.size());
+    output.resize(deflateBound(&stream, message.size()) + 16);
+    size_t produced = 0;
+    do {
+        if (produced == output.size()) {
+            output.resize(output.size() * 2);
+        }
+        stream.next_out = reinterpret_cast<Bytef*>(&output[produced]);
+        stream.avail_out = static_cast<uInt>(output.size() - produced);
+        if (deflate(&stream, Z_SYNC_FLUSH) == Z_STREAM_ERROR) {
+            output.clear();
+            return output;
+        }
+        produced = output.size() - stream.avail_out;
+    } while (stream.avail_out == 0);
+
+    // A sync flush ends in an empty stored block, which the receiver appends itself
+    output.resize(produced >= 4 ? produced - 4 : produced);
+    return output;
+}
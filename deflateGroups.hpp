@@ -0,0 +1,74 @@
+// deflateGroups.hpp
+#ifndef DEFLATEGROUPS_HPP
+#define DEFLATEGROUPS_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <zlib.h>
+
+// Server-to-client parameters of a negotiated permessage-deflate extension
+// (RFC 7692), read from the Sec-WebSocket-Extensions response header
+struct DeflateParams {
+    int windowBits = 15;
+    bool noContextTakeover = false;
+
+    bool operator==(const DeflateParams& other) const {
+        return windowBits == other.windowBits && noContextTakeover == other.noContextTakeover;
+    }
+
+    // False if the header does not accept permessage-deflate, or asks for a
+    // window zlib cannot honour (8 bits), in which case messages go uncompressed
+    static bool parse(const std::string& extensionsHeader, DeflateParams& params);
+};
+
+// Compression contexts shared by connections that receive the same broadcast
+// stream. With context takeover a client's decompressor keeps a window of
+// every compressed message it has received, so connections can share a
+// compressor only if they have received exactly the same compressed messages
+// since it started. A new connection therefore starts in a group of its own
+// with an empty history; old window contents never matter, only a gap between
+// two messages of the same compressor would. merge() folds all groups with
+// the same parameters into one with a fresh context, which is safe right
+// before a message every member receives (a full snapshot) and keeps the
+// number of groups, and so the number of compressions per broadcast, small.
+//
+// Not thread-safe: owned by the publisher thread.
+class DeflateGroups {
+public:
+    using GroupId = uint64_t;
+
+    DeflateGroups() = default;
+    DeflateGroups(const DeflateGroups&) = delete;
+    DeflateGroups& operator=(const DeflateGroups&) = delete;
+
+    GroupId join(const DeflateParams& params);
+    void leave(GroupId group);
+
+    // Returns old group -> surviving group for every group that was merged away
+    std::unordered_map<GroupId, GroupId> merge();
+
+    // One permessage-deflate payload (raw deflate, sync flush, trailing
+    // 00 00 ff ff removed), valid until the next call. Empty on zlib failure.
+    const std::string& compress(GroupId group, const std::string& message);
+
+    size_t size() const { return groups.size(); }
+
+private:
+    struct Group {
+        DeflateParams params;
+        size_t members = 0;
+        z_stream stream;
+
+        explicit Group(const DeflateParams& deflateParams);
+        ~Group();
+    };
+
+    std::unordered_map<GroupId, std::unique_ptr<Group>> groups;
+    GroupId nextGroup = 1;
+    std::string output;
+};
+
+#endif
@@ -0,0 +1,70 @@
+// busy_poll_quoter.cpp
+// LobClient in busy-poll mode: keeps a two-sided quote around a drifting mid
+// on a running trading_system, re-pricing both sides with modifies every few
+// milliseconds, and reports how long re-quotes took to be acknowledged.
+//
+//   ./examples/busy_poll_quoter [host] [port] [seconds]
+#include "../lobClient.hpp"
+#include "../latencyHistogram.hpp"
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <iostream>
+#include <string>
+#include <unordered_map>
+
+int main(int argc, char* argv[]) {
+    std::string host = (argc > 1) ? argv[1] : "127.0.0.1";
+    int port = (argc > 2) ? std::atoi(argv[2]) : 8080;
+    int seconds = (argc > 3) ? std::atoi(argv[3]) : 5;
+
+    LobClient client(LobClient::BUSY_POLL);
+    if (!client.connect(host, port)) return 1;
+
+    LatencyHistogram requote;
+    std::unordered_map<uint64_t, std::chrono::steady_clock::time_point> sentAt;
+    size_t rejected = 0;
+    size_t fills = 0;
+    client.on_ack([&](const OrderAck& ack) {
+        auto it = sentAt.find(ack.requestId);
+        if (it != sentAt.end()) {
+            requote.record(std::chrono::duration_cast<std::chrono::nanoseconds>(
+                std::chrono::steady_clock::now() - it->second).count());
+            sentAt.erase(it);
+        }
+        if (!ack.accepted) rejected++;
+    });
+    client.on_execution([&](const ExecutionView&) { fills++; });
+
+    double mid = 100.0;
+    uint64_t bid = client.submit(BUY, mid - 0.05, 100);
+    uint64_t ask = client.submit(SELL, mid + 0.05, 100);
+
+    auto start = std::chrono::steady_clock::now();
+    auto nextQuote = start;
+    auto end = start + std::chrono::seconds(seconds);
+    while (std::chrono::steady_clock::now() < end) {
+        auto now = std::chrono::steady_clock::now();
+        // Only re-quote once the previous quote is acknowledged
+        if (now >= nextQuote && client.outstanding() == 0) {
+            double elapsed = std::chrono::duration<double>(now - start).count();
+            mid = 100.0 + 0.25 * std::sin(elapsed);
+            sentAt[client.modify(bid, std::round((mid - 0.05) * 100) / 100, 100)] = now;
+            sentAt[client.modify(ask, std::round((mid + 0.05) * 100) / 100, 100)] = now;
+            nextQuote = now + std::chrono::milliseconds(5);
+        }
+        if (client.poll(0) < 0) {
+            std::cerr << "Disconnected" << std::endl;
+            return 1;
+        }
+    }
+    client.cancel(bid);
+    client.cancel(ask);
+    while (client.outstanding() > 0 && client.poll(1000) >= 0) {
+    }
+
+    std::cout << requote.count() << " re-quotes, ack p50 " << requote.percentile(0.50) << "ns, p99 "
+              << requote.percentile(0.99) << "ns, max " << requote.max() << "ns; " << rejected
+              << " rejected, " << fills << " executions seen" << std::endl;
+    return 0;
+}
@@ -0,0 +1,50 @@
+// submit_and_cancel.cpp
+// LobClient in blocking mode against a running trading_system: a small bid
+// ladder goes out in one write, one order is cancelled and another re-priced
+// before their acks are back, and a crossing sell trades into the ladder.
+//
+//   ./examples/submit_and_cancel [host] [port]
+#include "../lobClient.hpp"
+#include <cstdlib>
+#include <iostream>
+#include <string>
+
+int main(int argc, char* argv[]) {
+    std::string host = (argc > 1) ? argv[1] : "127.0.0.1";
+    int port = (argc > 2) ? std::atoi(argv[2]) : 8080;
+
+    LobClient client(LobClient::BLOCKING);
+    if (!client.connect(host, port)) return 1;
+
+    client.on_ack([](const OrderAck& ack) {
+        static const char* kinds[] = {"submit", "cancel", "modify"};
+        std::cout << "ack " << ack.requestId << " (" << kinds[ack.kind] << "): "
+                  << (ack.accepted ? "accepted" : "rejected") << " order " << ack.orderId;
+        if (!ack.message.empty()) std::cout << " - " << ack.message;
+        std::cout << std::endl;
+    });
+    client.on_execution([](const ExecutionView& execution) {
+        std::cout << "execution " << execution.executionId << ": " << execution.orderId << " "
+                  << (execution.side == BUY ? "BUY " : "SELL ") << execution.filledQuantity << " @ "
+                  << execution.averagePrice << ", " << execution.remainingQuantity << " left" << std::endl;
+    });
+
+    // Nothing is written until poll() (or flush()), so all of this is one send
+    uint64_t ladder[5];
+    for (int i = 0; i < 5; ++i) {
+        ladder[i] = client.submit(BUY, 99.00 - i * 0.05, 100);
+    }
+    client.cancel(ladder[4]);
+    client.modify(ladder[3], 98.90, 50);
+    client.submit(SELL, 98.95, 150);
+
+    while (client.outstanding() > 0) {
+        if (client.poll(1000) < 0) {
+            std::cerr << "Disconnected with " << client.outstanding() << " requests unanswered" << std::endl;
+            return 1;
+        }
+    }
+    // Executions may trail the last ack by a moment
+    client.poll(100);
+    return 0;
+}
@@ -0,0 +1,151 @@
+// flowToxicity.cpp
+#include "flowToxicity.hpp"
+#include <algorithm>
+#include <cstdlib>
+
+FlowToxicityMonitor::FlowToxicityMonitor(int64_t bucket, uint32_t window, double alertThreshold)
+    : bucketVolume(std::max<int64_t>(1, bucket)), windowBuckets(std::max<uint32_t>(1, window)),
+      threshold(alertThreshold), running(false) {
+}
+
+FlowToxicityMonitor::~FlowToxicityMonitor() {
+    stop();
+}
+
+bool FlowToxicityMonitor::start() {
+    if (running) return true;
+
+    running = true;
+    analyticsThread = std::thread(&FlowToxicityMonitor::analytics_worker, this);
+    return true;
+}
+
+void FlowToxicityMonitor::stop() {
+    if (!running) return;
+
+    {
+        std::lock_guard<std::mutex> lock(queueMutex);
+        running = false;
+    }
+    queueCondition.notify_one();
+    if (analyticsThread.joinable()) {
+        analyticsThread.join();
+    }
+}
+
+void FlowToxicityMonitor::record(const ExecutionReport& report) {
+    if (report.filledQuantity <= 0) return;
+
+    {
+        std::lock_guard<std::mutex> lock(queueMutex);
+        pending.push_back({report.symbol, report.side, report.filledQuantity});
+    }
+    queueCondition.notify_one();
+}
+
+bool FlowToxicityMonitor::get_metrics(const std::string& symbol, FlowMetrics& out) const {
+    std::lock_guard<std::mutex> lock(metricsMutex);
+    auto it = flows.find(symbol);
+    if (it == flows.end()) return false;
+
+    out = it->second.metrics;
+    return true;
+}
+
+std::vector<std::pair<std::string, FlowMetrics>> FlowToxicityMonitor::get_all_metrics() const {
+    std::lock_guard<std::mutex> lock(metricsMutex);
+    std::vector<std::pair<std::string, FlowMetrics>> result;
+    result.reserve(flows.size());
+    for (const auto& entry : flows) {
+        result.emplace_back(entry.first, entry.second.metrics);
+    }
+    return result;
+}
+
+void FlowToxicityMonitor::analytics_worker() {
+    std::vector<FlowEvent> batch;
+    std::vector<std::pair<std::string, FlowMetrics>> alerts;
+
+    std::unique_lock<std::mutex> lock(queueMutex);
+    while (true) {
+        queueCondition.wait(lock, [this] { return !pending.empty() || !running; });
+        if (pending.empty() && !running) break;
+
+        batch.swap(pending);
+        lock.unlock();
+
+        {
+            std::lock_guard<std::mutex> metricsLock(metricsMutex);
+            for (const auto& event : batch) {
+                SymbolFlow& flow = flows[event.symbol];
+                bool wasToxic = flow.metrics.toxic;
+                apply(flow, event.side, event.quantity);
+                if (threshold > 0 && flow.metrics.toxic != wasToxic) {
+                    alerts.emplace_back(event.symbol, flow.metrics);
+                }
+            }
+        }
+        batch.clear();
+
+        // Alerts run outside the metrics lock so they may query metrics themselves
+        if (onAlert) {
+            for (const auto& alert : alerts) {
+                onAlert(alert.first, alert.second);
+            }
+        }
+        alerts.clear();
+
+        lock.lock();
+    }
+}
+
+void FlowToxicityMonitor::apply(SymbolFlow& flow, OrderType side, int64_t quantity) {
+    FlowMetrics& metrics = flow.metrics;
+    metrics.executions++;
+    metrics.totalVolume += quantity;
+
+    // Large executions are split across as many buckets as they fill
+    while (quantity > 0) {
+        int64_t room = bucketVolume - metrics.bucketBuyVolume - metrics.bucketSellVolume;
+        int64_t take = std::min(room, quantity);
+        if (side == BUY) {
+            metrics.bucketBuyVolume += take;
+        } else {
+            metrics.bucketSellVolume += take;
+        }
+        quantity -= take;
+
+        if (take == room) {
+            close_bucket(flow);
+        }
+    }
+}
+
+void FlowToxicityMonitor::close_bucket(SymbolFlow& flow) {
+    FlowMetrics& metrics = flow.metrics;
+    int64_t imbalance = metrics.bucketBuyVolume - metrics.bucketSellVolume;
+    metrics.bucketBuyVolume = 0;
+    metrics.bucketSellVolume = 0;
+
+    if (flow.bucketImbalance.size() < windowBuckets) {
+        flow.bucketImbalance.push_back(imbalance);
+    } else {
+        int64_t evicted = flow.bucketImbalance[flow.head];
+        flow.absImbalanceSum -= std::llabs(evicted);
+        flow.imbalanceSum -= evicted;
+        flow.bucketImbalance[flow.head] = imbalance;
+        flow.head = (flow.head + 1) % windowBuckets;
+    }
+    flow.absImbalanceSum += std::llabs(imbalance);
+    flow.imbalanceSum += imbalance;
+
+    metrics.buckets = static_cast<uint32_t>(flow.bucketImbalance.size());
+    double windowVolume = static_cast<double>(metrics.buckets) * bucketVolume;
+    metrics.vpin = flow.absImbalanceSum / windowVolume;
+    metrics.orderFlowImbalance = flow.imbalanceSum / windowVolume;
+
+    // Only a full window is a meaningful estimate
+    if (threshold > 0 && metrics.buckets == windowBuckets) {
+        metrics.toxic = metrics.vpin >= threshold;
+    }
+}
@@ -0,0 +1,93 @@
+// flowToxicity.hpp
+#ifndef FLOWTOXICITY_HPP
+#define FLOWTOXICITY_HPP
+
+#include "order.hpp"
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <queue>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+// Latest flow metrics of one symbol
+struct FlowMetrics {
+    double vpin = 0.0;                  // sum |buy - sell| / (buckets * bucketVolume)
+    double orderFlowImbalance = 0.0;    // sum (buy - sell) / (buckets * bucketVolume), in [-1, 1]
+    uint32_t buckets = 0;               // complete buckets in the window
+    int64_t bucketBuyVolume = 0;        // current, incomplete bucket
+    int64_t bucketSellVolume = 0;
+    int64_t totalVolume = 0;
+    uint64_t executions = 0;
+    bool toxic = false;
+};
+
+// Volume-synchronized flow toxicity. Executed volume is classified by the
+// aggressor side the engine reports and filled into buckets of bucketVolume
+// shares; VPIN and order-flow imbalance are kept over the last windowBuckets
+// complete buckets with running sums, so each execution costs O(1) (plus one
+// step per bucket boundary it crosses).
+//
+// record() is called on the matching thread and only queues the execution;
+// all bucketing runs on the analytics thread. The alert callback also runs
+// there, once each time a symbol's VPIN crosses above threshold and once when
+// it falls back below.
+class FlowToxicityMonitor {
+public:
+    using AlertCallback = std::function<void(const std::string& symbol, const FlowMetrics& metrics)>;
+
+    FlowToxicityMonitor(int64_t bucketVolume, uint32_t windowBuckets = 50, double threshold = 0.0);
+    ~FlowToxicityMonitor();
+
+    bool start();
+    void stop();
+
+    // Matching thread only
+    void record(const ExecutionReport& report);
+
+    void set_alert_callback(AlertCallback callback) { onAlert = std::move(callback); }
+
+    // Any thread
+    bool get_metrics(const std::string& symbol, FlowMetrics& out) const;
+    std::vector<std::pair<std::string, FlowMetrics>> get_all_metrics() const;
+
+private:
+    struct FlowEvent {
+        std::string symbol;
+        OrderType side;
+        int quantity;
+    };
+    struct SymbolFlow {
+        std::vector<int64_t> bucketImbalance;   // ring of buy - sell per complete bucket
+        uint32_t head = 0;
+        int64_t absImbalanceSum = 0;
+        int64_t imbalanceSum = 0;
+        FlowMetrics metrics;
+    };
+
+    int64_t bucketVolume;
+    uint32_t windowBuckets;
+    double threshold;
+    AlertCallback onAlert;
+
+    // Hand-off to the analytics thread
+    std::vector<FlowEvent> pending;
+    std::mutex queueMutex;
+    std::condition_variable queueCondition;
+    std::thread analyticsThread;
+    std::atomic<bool> running;
+
+    // Owned by the analytics thread; metrics are published under metricsMutex
+    std::unordered_map<std::string, SymbolFlow> flows;
+    mutable std::mutex metricsMutex;
+
+    void analytics_worker();
+    void apply(SymbolFlow& flow, OrderType side, int64_t quantity);
+    void close_bucket(SymbolFlow& flow);
+};
+
+#endif
@@ -278,6 +278,10 @@ class TradingInterface {
                 this.handleRealTrade(data);
                 break;
                 
+            case 'execution':
+                this.handleExecution(data);
+                break;
+                
             case 'orderbook_update':
                 this.handleOrderBookUpdate(data);
                 break;
@@ -319,6 +323,19 @@ class TradingInterface {
         this.updateCandlestickChart(tradeData);
     }
 
+    handleExecution(data) {
+        // A sweep arrives as one message; show each passive fill as a trade,
+        // keyed by execution and fill index
+        data.fills.forEach((fill, index) => {
+            this.handleRealTrade({
+                tradeId: `${data.executionId}-${index}`,
+                symbol: data.symbol,
+                price: fill.price,
+                quantity: fill.quantity
+            });
+        });
+    }
+
     handleOrderBookUpdate(data) {
         // Update market data display
         document.getElementById('bestBid').textContent = `$${data.bestBid.toFixed(2)}`;
@@ -27,6 +27,7 @@ elif [[ "$OSTYPE" == "linux-gnu"* ]]; then
         libboost-all-dev \
         libwebsocketpp-dev \
         nlohmann-json3-dev \
+        zlib1g-dev \
         cmake
     
 else
@@ -0,0 +1,176 @@
+// instrument.cpp
+#include "instrument.hpp"
+#include <cstring>
+#include <fstream>
+#include <sstream>
+
+namespace {
+
+struct InstrumentFileHeader {
+    char magic[4];
+    uint32_t version;
+    uint32_t count;
+    uint32_t recordSize;
+};
+
+constexpr char INSTRUMENT_MAGIC[4] = {'L', 'O', 'B', 'I'};
+constexpr uint32_t INSTRUMENT_FILE_VERSION = 1;
+
+void set_error(std::string* error, const std::string& message) {
+    if (error) *error = message;
+}
+
+} // namespace
+
+bool InstrumentMaster::load(const std::string& filename, std::string* error) {
+    if (filename.size() >= 4 && filename.compare(filename.size() - 4, 4, ".csv") == 0) {
+        return load_csv(filename, error);
+    }
+    return load_binary(filename, error);
+}
+
+bool InstrumentMaster::load_csv(const std::string& filename, std::string* error) {
+    std::ifstream file(filename);
+    if (!file.is_open()) {
+        set_error(error, "Could not open file " + filename);
+        return false;
+    }
+
+    std::string line;
+    size_t lineNumber = 0;
+    while (std::getline(file, line)) {
+        ++lineNumber;
+        if (line.empty() || line[0] == '#') continue;
+        if (lineNumber == 1 && line.find("symbol") != std::string::npos) continue;
+
+        Instrument instrument;
+        if (!parse_csv_line(line, instrument) || add_instrument(instrument) == INVALID_SYMBOL_ID) {
+            set_error(error, filename + ":" + std::to_string(lineNumber) + ": invalid instrument '" + line + "'");
+            return false;
+        }
+    }
+    return true;
+}
+
+bool InstrumentMaster::load_binary(const std::string& filename, std::string* error) {
+    std::ifstream file(filename, std::ios::binary);
+    if (!file.is_open()) {
+        set_error(error, "Could not open file " + filename);
+        return false;
+    }
+
+    InstrumentFileHeader header;
+    if (!file.read(reinterpret_cast<char*>(&header), sizeof(header)) ||
+        std::memcmp(header.magic, INSTRUMENT_MAGIC, sizeof(INSTRUMENT_MAGIC)) != 0 ||
+        header.version != INSTRUMENT_FILE_VERSION || header.recordSize != sizeof(Instrument)) {
+        set_error(error, filename + ": not an instrument file of version " +
+                  std::to_string(INSTRUMENT_FILE_VERSION));
+        return false;
+    }
+
+    std::vector<Instrument> records(header.count);
+    if (!file.read(reinterpret_cast<char*>(records.data()), header.count * sizeof(Instrument))) {
+        set_error(error, filename + ": truncated instrument file");
+        return false;
+    }
+
+    for (const auto& record : records) {
+        if (add_instrument(record) == INVALID_SYMBOL_ID) {
+            set_error(error, filename + ": invalid instrument record");
+            return false;
+        }
+    }
+    return true;
+}
+
+bool InstrumentMaster::save_binary(const std::string& filename) const {
+    std::ofstream file(filename, std::ios::binary | std::ios::trunc);
+    if (!file.is_open()) return false;
+
+    InstrumentFileHeader header;
+    std::memcpy(header.magic, INSTRUMENT_MAGIC, sizeof(INSTRUMENT_MAGIC));
+    header.version = INSTRUMENT_FILE_VERSION;
+    header.count = static_cast<uint32_t>(instruments.size());
+    header.recordSize = sizeof(Instrument);
+
+    file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    file.write(reinterpret_cast<const char*>(instruments.data()), instruments.size() * sizeof(Instrument));
+    return static_cast<bool>(file);
+}
+
+uint32_t InstrumentMaster::add_instrument(Instrument instrument) {
+    instrument.symbol[Instrument::MAX_SYMBOL_LEN - 1] = '\0';
+    std::string symbol(instrument.symbol);
+
+    if (symbol.empty() || symbolIds.count(symbol) || instrument.lotSize <= 0) return INVALID_SYMBOL_ID;
+    if (instrument.tickBandCount == 0 || instrument.tickBandCount > Instrument::MAX_TICK_BANDS) {
+        return INVALID_SYMBOL_ID;
+    }
+    if (instrument.tickBands[0].fromPrice != 0) return INVALID_SYMBOL_ID;
+    for (int i = 0; i < instrument.tickBandCount; ++i) {
+        if (instrument.tickBands[i].tickSize <= 0) return INVALID_SYMBOL_ID;
+        if (i > 0 && instrument.tickBands[i].fromPrice <= instrument.tickBands[i - 1].fromPrice) {
+            return INVALID_SYMBOL_ID;
+        }
+    }
+    if (instrument.maxPrice > 0 && instrument.maxPrice < instrument.minPrice) return INVALID_SYMBOL_ID;
+
+    instrument.symbolId = static_cast<uint32_t>(instruments.size());
+    instruments.push_back(instrument);
+    symbolIds.emplace(symbol, instrument.symbolId);
+    return instrument.symbolId;
+}
+
+uint32_t InstrumentMaster::find(const std::string& symbol) const {
+    auto it = symbolIds.find(symbol);
+    return (it != symbolIds.end()) ? it->second : INVALID_SYMBOL_ID;
+}
+
+bool InstrumentMaster::parse_csv_line(const std::string& line, Instrument& instrument) const {
+    std::istringstream iss(line);
+    std::string token;
+    std::vector<std::string> tokens;
+
+    while (std::getline(iss, token, ',')) {
+        tokens.push_back(token);
+    }
+    // Older files carried a book column between max_price and tick_bands; it only
+    // ever allowed "map", so such rows are still read and the column is skipped
+    if (tokens.size() == 6) {
+        if (!tokens[4].empty() && tokens[4] != "map") return false;
+        tokens.erase(tokens.begin() + 4);
+    }
+    if (tokens.size() != 5 || tokens[0].size() >= Instrument::MAX_SYMBOL_LEN) return false;
+
+    try {
+        std::memset(&instrument, 0, sizeof(instrument));
+        std::memcpy(instrument.symbol, tokens[0].data(), tokens[0].size());
+        instrument.lotSize = std::stoi(tokens[1]);
+        instrument.minPrice = to_price_units(std::stod(tokens[2]));
+        instrument.maxPrice = to_price_units(std::stod(tokens[3]));
+
+        std::istringstream bands(tokens[4]);
+        std::string band;
+        while (std::getline(bands, band, '|')) {
+            size_t colon = band.find(':');
+            if (colon == std::string::npos || instrument.tickBandCount == Instrument::MAX_TICK_BANDS) return false;
+            TickBand& tickBand = instrument.tickBands[instrument.tickBandCount++];
+            tickBand.fromPrice = to_price_units(std::stod(band.substr(0, colon)));
+            tickBand.tickSize = to_price_units(std::stod(band.substr(colon + 1)));
+        }
+        return true;
+    } catch (const std::exception&) {
+        return false;
+    }
+}
+
+const char* instrument_check_to_string(InstrumentCheck check) {
+    switch (check) {
+        case INSTRUMENT_OK: return "ok";
+        case UNKNOWN_SYMBOL: return "unknown symbol";
+        case OFF_TICK: return "price not on tick";
+        case OFF_LOT: return "quantity not a multiple of lot size";
+        case OUTSIDE_PRICE_BAND: return "price outside band";
+    }
+    return "unknown";
+}
@@ -0,0 +1,86 @@
+// instrument.hpp
+#ifndef INSTRUMENT_HPP
+#define INSTRUMENT_HPP
+
+#include <cstdint>
+#include <cmath>
+#include <string>
+#include <vector>
+#include <unordered_map>
+
+enum InstrumentCheck { INSTRUMENT_OK, UNKNOWN_SYMBOL, OFF_TICK, OFF_LOT, OUTSIDE_PRICE_BAND };
+
+// Tick regime starting at fromPrice (inclusive); prices in integer price units
+struct TickBand {
+    int64_t fromPrice;
+    int64_t tickSize;
+};
+
+// Reference data for one symbol. Plain data so the binary file is just an array of these.
+struct Instrument {
+    static constexpr int MAX_SYMBOL_LEN = 16;
+    static constexpr int MAX_TICK_BANDS = 4;
+
+    char symbol[MAX_SYMBOL_LEN];
+    uint32_t symbolId;
+    int32_t lotSize;
+    int64_t minPrice;                      // 0 = no lower band
+    int64_t maxPrice;                      // 0 = no upper band
+    TickBand tickBands[MAX_TICK_BANDS];    // ascending by fromPrice, first starts at 0
+    uint8_t tickBandCount;
+
+    int64_t tick_size_at(int64_t price) const {
+        int band = tickBandCount - 1;
+        while (band > 0 && price < tickBands[band].fromPrice) --band;
+        return tickBands[band].tickSize;
+    }
+};
+
+class InstrumentMaster {
+public:
+    // Integer price units per 1.0 of quoted price
+    static constexpr int64_t PRICE_SCALE = 1000000;
+    static constexpr uint32_t INVALID_SYMBOL_ID = UINT32_MAX;
+
+    InstrumentMaster() = default;
+
+    // CSV: symbol,lot_size,min_price,max_price,tick_bands
+    // tick_bands is "from:tick|from:tick|...", e.g. "0:0.0001|1:0.01"
+    bool load_csv(const std::string& filename, std::string* error = nullptr);
+    bool load_binary(const std::string& filename, std::string* error = nullptr);
+    bool save_binary(const std::string& filename) const;
+    bool load(const std::string& filename, std::string* error = nullptr);
+
+    // Returns the assigned symbol ID, or INVALID_SYMBOL_ID if the definition is unusable
+    uint32_t add_instrument(Instrument instrument);
+
+    // Symbol resolution is the only map lookup; do it once at the edge and keep the ID
+    uint32_t find(const std::string& symbol) const;
+    const Instrument& get(uint32_t symbolId) const { return instruments[symbolId]; }
+    size_t size() const { return instruments.size(); }
+    bool empty() const { return instruments.empty(); }
+
+    static int64_t to_price_units(double price) { return std::llround(price * PRICE_SCALE); }
+    static double from_price_units(int64_t units) { return static_cast<double>(units) / PRICE_SCALE; }
+
+    InstrumentCheck validate(uint32_t symbolId, int64_t price, int quantity) const {
+        if (symbolId >= instruments.size()) return UNKNOWN_SYMBOL;
+        const Instrument& instrument = instruments[symbolId];
+        if (price < instrument.minPrice || (instrument.maxPrice > 0 && price > instrument.maxPrice)) {
+            return OUTSIDE_PRICE_BAND;
+        }
+        if (quantity % instrument.lotSize != 0) return OFF_LOT;
+        if (price % instrument.tick_size_at(price) != 0) return OFF_TICK;
+        return INSTRUMENT_OK;
+    }
+
+private:
+    std::vector<Instrument> instruments;
+    std::unordered_map<std::string, uint32_t> symbolIds;
+
+    bool parse_csv_line(const std::string& line, Instrument& instrument) const;
+};
+
+const char* instrument_check_to_string(InstrumentCheck check);
+
+#endif
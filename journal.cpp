@@ -0,0 +1,473 @@
+// journal.cpp
+#include "journal.hpp"
+#include "instrument.hpp"
+#include "varint.hpp"
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <filesystem>
+#include <iostream>
+#include <string_view>
+#include <unordered_map>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace {
+
+constexpr char JOURNAL_MAGIC[8] = {'L', 'O', 'B', 'J', 'R', 'N', 'L', '1'};
+constexpr uint32_t BLOCK_MAGIC = 0x4b4c424a; // "JBLK"
+
+struct JournalFileHeader {
+    char magic[8];
+    uint32_t encoding;
+    uint32_t reserved;
+};
+
+struct JournalBlockHeader {
+    uint32_t magic;
+    uint32_t count;
+    uint32_t payloadBytes;
+    uint32_t checksum;
+    int64_t baseTimestampNs;    // COMPACT: first timestamp delta of each symbol is against this
+};
+
+// Tag byte of a COMPACT record
+constexpr uint8_t TAG_COMMAND_MASK = 0x03;
+constexpr uint8_t TAG_SELL = 0x04;
+constexpr uint8_t TAG_NEW_SYMBOL = 0x08;
+
+// Tag, symbol definition and four varints
+constexpr size_t MAX_COMPACT_RECORD_BYTES = 1 + 1 + 16 + 4 * MAX_VARINT_BYTES;
+
+// Previous record of one symbol within a block
+struct DeltaState {
+    int64_t timestampNs;
+    uint64_t orderId;
+    int64_t priceUnits;
+};
+
+int64_t now_ns() {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::system_clock::now().time_since_epoch()).count();
+}
+
+size_t symbol_length(const char (&symbol)[16]) {
+    return strnlen(symbol, sizeof(symbol));
+}
+
+uint8_t* encode_compact(const std::vector<JournalRecord>& records, int64_t baseTimestampNs, uint8_t* out) {
+    std::unordered_map<std::string_view, uint32_t> symbolIndex;
+    std::vector<DeltaState> states;
+
+    for (const JournalRecord& record : records) {
+        std::string_view symbol(record.symbol, symbol_length(record.symbol));
+        auto inserted = symbolIndex.try_emplace(symbol, static_cast<uint32_t>(states.size()));
+        uint32_t index = inserted.first->second;
+
+        uint8_t tag = static_cast<uint8_t>(record.command & TAG_COMMAND_MASK);
+        if (record.side == SELL) tag |= TAG_SELL;
+        if (inserted.second) {
+            states.push_back({baseTimestampNs, 0, 0});
+            *out++ = tag | TAG_NEW_SYMBOL;
+            *out++ = static_cast<uint8_t>(symbol.size());
+            std::memcpy(out, symbol.data(), symbol.size());
+            out += symbol.size();
+        } else {
+            *out++ = tag;
+            out = put_varint(out, index);
+        }
+
+        DeltaState& state = states[index];
+        out = put_varint(out, zigzag(record.timestampNs - state.timestampNs));
+        out = put_varint(out, zigzag(static_cast<int64_t>(record.orderId - state.orderId)));
+        state.timestampNs = record.timestampNs;
+        state.orderId = record.orderId;
+
+        if (record.command != JOURNAL_CANCEL) {
+            int64_t priceUnits = InstrumentMaster::to_price_units(record.price);
+            out = put_varint(out, zigzag(priceUnits - state.priceUnits));
+            out = put_varint(out, static_cast<uint32_t>(record.quantity));
+            state.priceUnits = priceUnits;
+        }
+    }
+    return out;
+}
+
+bool decode_compact(const uint8_t* in, const uint8_t* end, size_t count, int64_t baseTimestampNs,
+                    std::vector<JournalRecord>& out) {
+    struct Symbol {
+        char name[16];
+        DeltaState state;
+    };
+    std::vector<Symbol> symbols;
+
+    out.resize(count);
+    for (size_t i = 0; i < count; ++i) {
+        if (in == end) return false;
+        uint8_t tag = *in++;
+
+        Symbol* symbol;
+        if (tag & TAG_NEW_SYMBOL) {
+            if (in == end) return false;
+            size_t length = *in++;
+            if (length > 15 || static_cast<size_t>(end - in) < length) return false;
+            symbols.emplace_back();
+            symbol = &symbols.back();
+            std::memset(symbol->name, 0, sizeof(symbol->name));
+            std::memcpy(symbol->name, in, length);
+            symbol->state = {baseTimestampNs, 0, 0};
+            in += length;
+        } else {
+            uint64_t index;
+            if (!(in = get_varint(in, end, index)) || index >= symbols.size()) return false;
+            symbol = &symbols[index];
+        }
+
+        JournalRecord& record = out[i];
+        std::memcpy(record.symbol, symbol->name, sizeof(record.symbol));
+        record.command = tag & TAG_COMMAND_MASK;
+        record.side = (tag & TAG_SELL) ? SELL : BUY;
+        if (record.command > JOURNAL_MODIFY) return false;
+
+        DeltaState& state = symbol->state;
+        uint64_t timestampDelta;
+        uint64_t orderDelta;
+        if (!(in = get_varint(in, end, timestampDelta)) || !(in = get_varint(in, end, orderDelta))) return false;
+        state.timestampNs += unzigzag(timestampDelta);
+        state.orderId += static_cast<uint64_t>(unzigzag(orderDelta));
+        record.timestampNs = state.timestampNs;
+        record.orderId = state.orderId;
+
+        record.price = 0.0;
+        record.quantity = 0;
+        if (record.command != JOURNAL_CANCEL) {
+            uint64_t priceDelta;
+            uint64_t quantity;
+            if (!(in = get_varint(in, end, priceDelta)) || !(in = get_varint(in, end, quantity))) return false;
+            state.priceUnits += unzigzag(priceDelta);
+            record.price = InstrumentMaster::from_price_units(state.priceUnits);
+            record.quantity = static_cast<int32_t>(quantity);
+        }
+    }
+    return in == end;
+}
+
+} // namespace
+
+CommandJournal::CommandJournal(const std::string& journalPath, JournalEncoding journalEncoding)
+    : path(journalPath), encoding(journalEncoding), openSinceNs(0), flushRequested(false), running(false),
+      recordsWritten(0), bytesWritten(0) {
+    current.reserve(BLOCK_RECORDS);
+}
+
+CommandJournal::~CommandJournal() {
+    stop();
+}
+
+bool CommandJournal::start() {
+    if (running) return true;
+
+    // Existing journals are appended to, provided they use the same encoding
+    std::error_code ec;
+    uint64_t existingSize = std::filesystem::exists(path, ec) ? std::filesystem::file_size(path, ec) : 0;
+    if (existingSize >= sizeof(JournalFileHeader)) {
+        std::ifstream existing(path, std::ios::binary);
+        JournalFileHeader header;
+        existing.read(reinterpret_cast<char*>(&header), sizeof(header));
+        if (std::memcmp(header.magic, JOURNAL_MAGIC, sizeof(JOURNAL_MAGIC)) != 0 || header.encoding != encoding) {
+            std::cerr << "Error: " << path << " is not a compatible command journal" << std::endl;
+            return false;
+        }
+    }
+
+    file.open(path, std::ios::binary | std::ios::app);
+    if (!file.is_open()) {
+        std::cerr << "Error: Could not open command journal " << path << std::endl;
+        return false;
+    }
+    if (existingSize < sizeof(JournalFileHeader)) {
+        JournalFileHeader header{};
+        std::memcpy(header.magic, JOURNAL_MAGIC, sizeof(JOURNAL_MAGIC));
+        header.encoding = encoding;
+        file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+        file.flush();
+    }
+
+    running = true;
+    writerThread = std::thread(&CommandJournal::writer_worker, this);
+    return true;
+}
+
+void CommandJournal::stop() {
+    if (!running) return;
+
+    flush();
+    {
+        std::lock_guard<std::mutex> lock(queueMutex);
+        running = false;
+    }
+    queueCondition.notify_one();
+    if (writerThread.joinable()) {
+        writerThread.join();
+    }
+    file.close();
+}
+
+uint64_t CommandJournal::order_number(const std::string& orderId) {
+    // Skip the letter prefix
+    return orderId.size() > 1 ? std::strtoull(orderId.c_str() + 1, nullptr, 10) : 0;
+}
+
+void CommandJournal::record_new(const std::string& orderId, const std::string& symbol, OrderType side, double price,
+                                int quantity) {
+    JournalRecord record{};
+    record.timestampNs = now_ns();
+    record.orderId = order_number(orderId);
+    record.price = price;
+    record.quantity = quantity;
+    record.command = JOURNAL_NEW;
+    record.side = static_cast<uint8_t>(side);
+    std::strncpy(record.symbol, symbol.c_str(), sizeof(record.symbol) - 1);
+    append(record);
+}
+
+void CommandJournal::record_cancel(const std::string& orderId, const std::string& symbol) {
+    JournalRecord record{};
+    record.timestampNs = now_ns();
+    record.orderId = order_number(orderId);
+    record.command = JOURNAL_CANCEL;
+    std::strncpy(record.symbol, symbol.c_str(), sizeof(record.symbol) - 1);
+    append(record);
+}
+
+void CommandJournal::record_modify(const std::string& orderId, const std::string& symbol, double price, int quantity) {
+    JournalRecord record{};
+    record.timestampNs = now_ns();
+    record.orderId = order_number(orderId);
+    record.price = price;
+    record.quantity = quantity;
+    record.command = JOURNAL_MODIFY;
+    std::strncpy(record.symbol, symbol.c_str(), sizeof(record.symbol) - 1);
+    append(record);
+}
+
+void CommandJournal::append(const JournalRecord& record) {
+    if (flushRequested.load(std::memory_order_relaxed) ||
+        (!current.empty() && record.timestampNs - current.front().timestampNs > MAX_BLOCK_AGE_NS)) {
+        flush_aged();
+    }
+
+    if (current.empty()) {
+        openSinceNs.store(record.timestampNs, std::memory_order_relaxed);
+    }
+    current.push_back(record);
+    if (current.size() >= BLOCK_RECORDS) {
+        submit_block();
+    }
+}
+
+void CommandJournal::flush() {
+    if (!current.empty()) {
+        submit_block();
+    }
+}
+
+void CommandJournal::flush_aged() {
+    flushRequested.store(false, std::memory_order_relaxed);
+    flush();
+}
+
+void CommandJournal::submit_block() {
+    openSinceNs.store(0, std::memory_order_relaxed);
+    std::vector<JournalRecord> next;
+    {
+        std::lock_guard<std::mutex> lock(queueMutex);
+        pending.push(std::move(current));
+        if (!freeBlocks.empty()) {
+            next = std::move(freeBlocks.back());
+            freeBlocks.pop_back();
+        }
+    }
+    queueCondition.notify_one();
+
+    current = std::move(next);
+    current.clear();
+    current.reserve(BLOCK_RECORDS);
+}
+
+void CommandJournal::writer_worker() {
+    std::unique_lock<std::mutex> lock(queueMutex);
+    auto nextSweep = std::chrono::steady_clock::now() + std::chrono::nanoseconds(MAX_BLOCK_AGE_NS / 4);
+    while (true) {
+        queueCondition.wait_until(lock, nextSweep, [this] { return !pending.empty() || !running; });
+        if (pending.empty() && !running) break;
+
+        // Only a flag: the block itself belongs to the matching thread
+        if (std::chrono::steady_clock::now() >= nextSweep) {
+            int64_t since = openSinceNs.load(std::memory_order_relaxed);
+            if (since != 0 && now_ns() - since >= MAX_BLOCK_AGE_NS) {
+                flushRequested.store(true, std::memory_order_relaxed);
+            }
+            nextSweep = std::chrono::steady_clock::now() + std::chrono::nanoseconds(MAX_BLOCK_AGE_NS / 4);
+            if (pending.empty()) continue;
+        }
+
+        std::vector<JournalRecord> records = std::move(pending.front());
+        pending.pop();
+        lock.unlock();
+
+        write_block(records);
+
+        lock.lock();
+        freeBlocks.push_back(std::move(records));
+    }
+}
+
+void CommandJournal::write_block(const std::vector<JournalRecord>& records) {
+    if (records.empty()) return;
+
+    JournalBlockHeader header{};
+    header.magic = BLOCK_MAGIC;
+    header.count = static_cast<uint32_t>(records.size());
+    header.baseTimestampNs = records.front().timestampNs;
+
+    std::vector<uint8_t>& out = encodeBuffer;
+    uint8_t* payload;
+    size_t payloadBytes;
+    if (encoding == JOURNAL_COMPACT) {
+        out.resize(sizeof(header) + records.size() * MAX_COMPACT_RECORD_BYTES);
+        payload = out.data() + sizeof(header);
+        payloadBytes = encode_compact(records, header.baseTimestampNs, payload) - payload;
+    } else {
+        payloadBytes = records.size() * sizeof(JournalRecord);
+        out.resize(sizeof(header) + payloadBytes);
+        payload = out.data() + sizeof(header);
+        std::memcpy(payload, records.data(), payloadBytes);
+    }
+
+    header.payloadBytes = static_cast<uint32_t>(payloadBytes);
+    header.checksum = checksum(payload, payloadBytes);
+    std::memcpy(out.data(), &header, sizeof(header));
+
+    file.write(reinterpret_cast<const char*>(out.data()), sizeof(header) + payloadBytes);
+    file.flush();
+
+    recordsWritten += records.size();
+    bytesWritten += sizeof(header) + payloadBytes;
+}
+
+JournalReader::~JournalReader() {
+    close();
+}
+
+bool JournalReader::open(const std::string& path) {
+    close();
+
+    int fd = ::open(path.c_str(), O_RDONLY);
+    if (fd < 0) {
+        std::cerr << "Error: Could not open command journal " << path << std::endl;
+        return false;
+    }
+
+    struct stat st;
+    if (fstat(fd, &st) != 0 || static_cast<size_t>(st.st_size) < sizeof(JournalFileHeader)) {
+        ::close(fd);
+        std::cerr << "Error: " << path << " is not a command journal" << std::endl;
+        return false;
+    }
+
+    void* mapping = mmap(nullptr, st.st_size, PROT_READ, MAP_SHARED, fd, 0);
+    ::close(fd);
+    if (mapping == MAP_FAILED) return false;
+
+    base = static_cast<const uint8_t*>(mapping);
+    mappedBytes = st.st_size;
+
+    JournalFileHeader header;
+    std::memcpy(&header, base, sizeof(header));
+    if (std::memcmp(header.magic, JOURNAL_MAGIC, sizeof(JOURNAL_MAGIC)) != 0 || header.encoding > JOURNAL_COMPACT) {
+        std::cerr << "Error: " << path << " is not a command journal" << std::endl;
+        close();
+        return false;
+    }
+    encoding = static_cast<JournalEncoding>(header.encoding);
+
+    // Walk the block headers; a torn block at the end (crash mid-write) is ignored
+    size_t offset = sizeof(JournalFileHeader);
+    while (offset + sizeof(JournalBlockHeader) <= mappedBytes) {
+        JournalBlockHeader block;
+        std::memcpy(&block, base + offset, sizeof(block));
+        if (block.magic != BLOCK_MAGIC || mappedBytes - offset - sizeof(block) < block.payloadBytes) break;
+
+        blockOffsets.push_back(offset);
+        offset += sizeof(block) + block.payloadBytes;
+    }
+    return true;
+}
+
+void JournalReader::close() {
+    if (base) {
+        munmap(const_cast<uint8_t*>(base), mappedBytes);
+        base = nullptr;
+        mappedBytes = 0;
+    }
+    blockOffsets.clear();
+}
+
+bool JournalReader::read_block(size_t block, std::vector<JournalRecord>& out) const {
+    if (block >= blockOffsets.size()) return false;
+
+    JournalBlockHeader header;
+    std::memcpy(&header, base + blockOffsets[block], sizeof(header));
+    const uint8_t* in = base + blockOffsets[block] + sizeof(header);
+    const uint8_t* end = in + header.payloadBytes;
+    if (header.count == 0 || header.checksum != checksum(in, header.payloadBytes)) return false;
+
+    if (encoding == JOURNAL_COMPACT) {
+        return decode_compact(in, end, header.count, header.baseTimestampNs, out);
+    }
+    if (header.payloadBytes != header.count * sizeof(JournalRecord)) return false;
+    out.resize(header.count);
+    std::memcpy(out.data(), in, header.payloadBytes);
+    return true;
+}
+
+std::vector<JournalRecord> JournalReader::read_all(unsigned threads) const {
+    size_t blocks = blockOffsets.size();
+    if (threads == 0) threads = std::max(1u, std::thread::hardware_concurrency());
+    threads = static_cast<unsigned>(std::min<size_t>(threads, std::max<size_t>(blocks, 1)));
+
+    std::vector<std::vector<JournalRecord>> decoded(blocks);
+    std::vector<uint8_t> ok(blocks, 0);
+    std::atomic<size_t> nextBlock(0);
+    auto worker = [&]() {
+        for (size_t block = nextBlock++; block < blocks; block = nextBlock++) {
+            ok[block] = read_block(block, decoded[block]);
+        }
+    };
+
+    std::vector<std::thread> workers;
+    for (unsigned i = 1; i < threads; ++i) {
+        workers.emplace_back(worker);
+    }
+    worker();
+    for (auto& thread : workers) {
+        thread.join();
+    }
+
+    std::vector<JournalRecord> records;
+    size_t total = 0;
+    for (const auto& block : decoded) total += block.size();
+    records.reserve(total);
+    for (size_t block = 0; block < blocks; ++block) {
+        if (!ok[block]) {
+            std::cerr << "Error: corrupt command journal block " << block << std::endl;
+            break;
+        }
+        records.insert(records.end(), decoded[block].begin(), decoded[block].end());
+    }
+    return records;
+}
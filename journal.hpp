@@ -0,0 +1,127 @@
+// journal.hpp
+#ifndef JOURNAL_HPP
+#define JOURNAL_HPP
+
+#include "order.hpp"
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <fstream>
+#include <mutex>
+#include <queue>
+#include <string>
+#include <thread>
+#include <vector>
+
+enum JournalCommand : uint8_t { JOURNAL_NEW = 0, JOURNAL_CANCEL = 1, JOURNAL_MODIFY = 2 };
+
+// One accepted command, as recorded and as replayed
+struct JournalRecord {
+    int64_t timestampNs;
+    uint64_t orderId;       // numeric part of the engine's order ID ("O42" -> 42)
+    double price;           // NEW and MODIFY
+    int32_t quantity;       // NEW and MODIFY
+    uint8_t command;        // JournalCommand
+    uint8_t side;           // NEW: BUY or SELL
+    char symbol[16];
+};
+
+// FIXED writes each JournalRecord as is. COMPACT delta-encodes every field
+// against the previous record of the same symbol in the block: zigzag varint
+// timestamp, order ID and price (in InstrumentMaster price units, so prices are
+// kept to six decimals) deltas, varint quantity, and a block-local symbol table.
+enum JournalEncoding : uint32_t { JOURNAL_FIXED = 0, JOURNAL_COMPACT = 1 };
+
+// A journal file is a header followed by self-contained blocks, each with its
+// own record count, payload size and checksum, so blocks can be decoded in any
+// order and on any thread. The matching thread only appends records to the
+// current block; blocks are encoded and written by a background thread. The
+// writer also checks the age of the current block every MAX_BLOCK_AGE_NS/4
+// and, once it is due, asks the matching thread to hand it over: the next
+// record does, and so does flush_aged() from whoever owns the engine while
+// the book is quiet. The two threads share no lock on the record path.
+class CommandJournal {
+public:
+    static constexpr size_t BLOCK_RECORDS = 4096;
+    static constexpr int64_t MAX_BLOCK_AGE_NS = 100000000;
+
+    CommandJournal(const std::string& path, JournalEncoding encoding = JOURNAL_COMPACT);
+    ~CommandJournal();
+
+    bool start();
+    void stop();
+
+    // Matching thread only
+    void record_new(const std::string& orderId, const std::string& symbol, OrderType side, double price, int quantity);
+    void record_cancel(const std::string& orderId, const std::string& symbol);
+    void record_modify(const std::string& orderId, const std::string& symbol, double price, int quantity);
+    void flush();
+    // Submits the current block if the writer asked for it
+    void flush_aged();
+
+    // Any thread; true once the current block is older than MAX_BLOCK_AGE_NS
+    bool flush_due() const { return flushRequested.load(std::memory_order_relaxed); }
+
+    size_t get_records_written() const { return recordsWritten.load(); }
+    size_t get_bytes_written() const { return bytesWritten.load(); }
+
+    static uint64_t order_number(const std::string& orderId);
+
+private:
+    std::string path;
+    JournalEncoding encoding;
+
+    // Owned by the matching thread
+    std::vector<JournalRecord> current;
+    std::atomic<int64_t> openSinceNs;       // first record of current, 0 while empty
+    std::atomic<bool> flushRequested;       // set by the writer, cleared by the matching thread
+
+    // Hand-off to the writer thread; written blocks come back through freeBlocks
+    std::queue<std::vector<JournalRecord>> pending;
+    std::vector<std::vector<JournalRecord>> freeBlocks;
+    std::mutex queueMutex;
+    std::condition_variable queueCondition;
+    std::thread writerThread;
+    std::atomic<bool> running;
+
+    // Owned by the writer thread
+    std::ofstream file;
+    std::vector<uint8_t> encodeBuffer;
+    std::atomic<size_t> recordsWritten;
+    std::atomic<size_t> bytesWritten;
+
+    void append(const JournalRecord& record);
+    void submit_block();
+    void writer_worker();
+    void write_block(const std::vector<JournalRecord>& records);
+};
+
+// Read-only memory mapping of a journal file with its block index
+class JournalReader {
+public:
+    JournalReader() = default;
+    ~JournalReader();
+    JournalReader(const JournalReader&) = delete;
+    JournalReader& operator=(const JournalReader&) = delete;
+
+    bool open(const std::string& path);
+    void close();
+
+    JournalEncoding get_encoding() const { return encoding; }
+    size_t get_block_count() const { return blockOffsets.size(); }
+
+    // Safe to call from several threads at once
+    bool read_block(size_t block, std::vector<JournalRecord>& out) const;
+
+    // Decodes all blocks on up to threads workers (0 = hardware concurrency) and
+    // returns the records in journal order; stops at the first corrupt block
+    std::vector<JournalRecord> read_all(unsigned threads = 0) const;
+
+private:
+    const uint8_t* base = nullptr;
+    size_t mappedBytes = 0;
+    JournalEncoding encoding = JOURNAL_FIXED;
+    std::vector<size_t> blockOffsets;
+};
+
+#endif
@@ -0,0 +1,251 @@
+// l2Exporter.cpp
+#include "l2Exporter.hpp"
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <filesystem>
+#include <iostream>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace {
+
+constexpr char L2_MAGIC[8] = {'L', 'O', 'B', 'L', '2', 'v', '0', '1'};
+
+int64_t now_ns() {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::system_clock::now().time_since_epoch()).count();
+}
+
+template <typename T>
+void put_column(std::vector<uint8_t>& block, size_t offset, uint32_t row, T value) {
+    std::memcpy(block.data() + offset + row * sizeof(T), &value, sizeof(T));
+}
+
+} // namespace
+
+L2Exporter::L2Exporter(const std::string& dir, int levels, uint64_t events, int64_t micros)
+    : directory(dir),
+      layout{static_cast<uint32_t>(std::max(1, std::min(levels, MAX_LEVELS))), BLOCK_ROWS},
+      everyEvents(events), everyNs(micros * 1000), running(false), snapshotsWritten(0) {
+}
+
+L2Exporter::~L2Exporter() {
+    stop();
+}
+
+bool L2Exporter::start() {
+    if (running) return true;
+
+    std::error_code ec;
+    std::filesystem::create_directories(directory, ec);
+    if (ec) {
+        std::cerr << "Error: Could not create L2 export directory " << directory << ": " << ec.message() << std::endl;
+        return false;
+    }
+
+    running = true;
+    writerThread = std::thread(&L2Exporter::writer_worker, this);
+    return true;
+}
+
+void L2Exporter::stop() {
+    if (!running) return;
+
+    // Partial blocks are written padded to full size to keep the file indexable
+    for (auto& entry : symbols) {
+        if (entry.second.rows > 0) {
+            submit_block(entry.first, entry.second);
+        }
+    }
+    {
+        std::lock_guard<std::mutex> lock(queueMutex);
+        running = false;
+    }
+    queueCondition.notify_one();
+    if (writerThread.joinable()) {
+        writerThread.join();
+    }
+    files.clear();
+}
+
+void L2Exporter::on_book_update(const std::string& symbol, const OrderBook& book) {
+    SymbolState& state = symbols[symbol];
+    state.events++;
+
+    bool sample = (everyEvents == 0 && everyNs == 0);
+    if (everyEvents > 0 && state.events % everyEvents == 0) {
+        sample = true;
+    }
+
+    int64_t timestampNs = 0;
+    if (everyNs > 0) {
+        timestampNs = now_ns();
+        if (timestampNs - state.lastSampleNs >= everyNs) sample = true;
+    }
+    if (!sample) return;
+
+    if (timestampNs == 0) timestampNs = now_ns();
+    state.lastSampleNs = timestampNs;
+
+    if (state.block.empty()) {
+        std::lock_guard<std::mutex> lock(queueMutex);
+        if (!freeBlocks.empty()) {
+            state.block = std::move(freeBlocks.back());
+            freeBlocks.pop_back();
+        }
+    }
+    if (state.block.empty()) {
+        state.block.resize(layout.block_bytes());
+    }
+
+    uint32_t row = state.rows;
+    put_column<int64_t>(state.block, layout.timestamp_offset(), row, timestampNs);
+    put_column<uint64_t>(state.block, layout.sequence_offset(), row, state.events);
+    capture(state, book);
+
+    if (++state.rows == layout.blockRows) {
+        submit_block(symbol, state);
+    }
+}
+
+void L2Exporter::capture(SymbolState& state, const OrderBook& book) {
+    uint32_t row = state.rows;
+    for (int side = L2BlockLayout::BID; side <= L2BlockLayout::ASK; ++side) {
+        int count = (side == L2BlockLayout::BID)
+            ? book.get_bid_levels(scratch, layout.levels)
+            : book.get_ask_levels(scratch, layout.levels);
+
+        for (int level = 0; level < static_cast<int>(layout.levels); ++level) {
+            DepthLevel depth = (level < count) ? scratch[level] : DepthLevel{0.0, 0, 0};
+            put_column<double>(state.block, layout.price_offset(side, level), row, depth.price);
+            put_column<int32_t>(state.block, layout.quantity_offset(side, level), row, depth.quantity);
+            put_column<int32_t>(state.block, layout.orders_offset(side, level), row, depth.orders);
+        }
+    }
+}
+
+void L2Exporter::submit_block(const std::string& symbol, SymbolState& state) {
+    uint32_t rows = state.rows;
+    std::memcpy(state.block.data(), &rows, sizeof(rows));
+
+    PendingBlock block{symbol, std::move(state.block)};
+    state.block.clear();
+    state.rows = 0;
+
+    {
+        std::lock_guard<std::mutex> lock(queueMutex);
+        pending.push(std::move(block));
+    }
+    queueCondition.notify_one();
+}
+
+void L2Exporter::writer_worker() {
+    std::unique_lock<std::mutex> lock(queueMutex);
+    while (true) {
+        queueCondition.wait(lock, [this] { return !pending.empty() || !running; });
+        if (pending.empty() && !running) break;
+
+        PendingBlock block = std::move(pending.front());
+        pending.pop();
+        lock.unlock();
+
+        write_block(block);
+
+        lock.lock();
+        freeBlocks.push_back(std::move(block.block));
+    }
+}
+
+void L2Exporter::write_block(PendingBlock& block) {
+    auto it = files.find(block.symbol);
+    if (it == files.end()) {
+        std::string path = directory + "/" + block.symbol + ".l2";
+
+        L2FileHeader header{};
+        std::memcpy(header.magic, L2_MAGIC, sizeof(L2_MAGIC));
+        header.levels = layout.levels;
+        header.blockRows = layout.blockRows;
+        header.blockBytes = layout.block_bytes();
+        header.headerBytes = sizeof(L2FileHeader);
+        std::strncpy(header.symbol, block.symbol.c_str(), sizeof(header.symbol) - 1);
+
+        // Existing exports are appended to, provided they have the same block layout
+        std::error_code ec;
+        uint64_t existingSize = std::filesystem::exists(path, ec) ? std::filesystem::file_size(path, ec) : 0;
+        if (existingSize > 0) {
+            std::ifstream existing(path, std::ios::binary);
+            L2FileHeader existingHeader{};
+            existing.read(reinterpret_cast<char*>(&existingHeader), sizeof(existingHeader));
+            if (!existing || std::memcmp(existingHeader.magic, L2_MAGIC, sizeof(L2_MAGIC)) != 0 ||
+                existingHeader.levels != header.levels || existingHeader.blockRows != header.blockRows ||
+                existingHeader.blockBytes != header.blockBytes || existingHeader.headerBytes != header.headerBytes ||
+                (existingSize - header.headerBytes) % header.blockBytes != 0) {
+                std::cerr << "Error: " << path << " is not a compatible L2 export" << std::endl;
+                return;
+            }
+        }
+
+        std::ofstream file(path, std::ios::binary | std::ios::app);
+        if (!file.is_open()) {
+            std::cerr << "Error: Could not open L2 export file " << path << std::endl;
+            return;
+        }
+        if (existingSize == 0) {
+            file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+        }
+
+        it = files.emplace(block.symbol, std::move(file)).first;
+    }
+
+    uint32_t rows;
+    std::memcpy(&rows, block.block.data(), sizeof(rows));
+    it->second.write(reinterpret_cast<const char*>(block.block.data()), block.block.size());
+    it->second.flush();
+    snapshotsWritten += rows;
+}
+
+L2SnapshotFile::~L2SnapshotFile() {
+    close();
+}
+
+bool L2SnapshotFile::open(const std::string& path) {
+    close();
+
+    int fd = ::open(path.c_str(), O_RDONLY);
+    if (fd < 0) return false;
+
+    struct stat st;
+    if (fstat(fd, &st) != 0 || static_cast<size_t>(st.st_size) < sizeof(L2FileHeader)) {
+        ::close(fd);
+        return false;
+    }
+
+    void* mapping = mmap(nullptr, st.st_size, PROT_READ, MAP_SHARED, fd, 0);
+    ::close(fd);
+    if (mapping == MAP_FAILED) return false;
+
+    base = static_cast<const uint8_t*>(mapping);
+    mappedBytes = st.st_size;
+
+    const L2FileHeader& fileHeader = header();
+    layout = L2BlockLayout{fileHeader.levels, fileHeader.blockRows};
+    if (std::memcmp(fileHeader.magic, L2_MAGIC, sizeof(L2_MAGIC)) != 0 ||
+        fileHeader.blockBytes != layout.block_bytes() || fileHeader.headerBytes != sizeof(L2FileHeader)) {
+        close();
+        return false;
+    }
+    blockCount = (mappedBytes - fileHeader.headerBytes) / fileHeader.blockBytes;
+    return true;
+}
+
+void L2SnapshotFile::close() {
+    if (base) {
+        munmap(const_cast<uint8_t*>(base), mappedBytes);
+        base = nullptr;
+        mappedBytes = 0;
+        blockCount = 0;
+    }
+}
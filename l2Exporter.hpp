@@ -0,0 +1,142 @@
+// l2Exporter.hpp
+#ifndef L2EXPORTER_HPP
+#define L2EXPORTER_HPP
+
+#include "orderBook.hpp"
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <fstream>
+#include <mutex>
+#include <queue>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+// <symbol>.l2 files are an L2FileHeader followed by fixed-size blocks, so they
+// can be mapped and indexed without parsing. Each block starts with a uint32
+// row count (padded to 8 bytes) followed by columns of blockRows entries:
+//   int64 timestampNs, uint64 eventSequence, then for each side (bid, ask) and
+//   level: double price, int32 quantity, int32 orders.
+// Missing levels have price 0 and quantity 0. An exporter appends to an
+// existing file with the same layout and refuses one with another.
+struct L2FileHeader {
+    char magic[8];
+    uint32_t levels;
+    uint32_t blockRows;
+    uint64_t blockBytes;
+    uint64_t headerBytes;
+    char symbol[16];
+    uint8_t reserved[16];
+};
+
+struct L2BlockLayout {
+    uint32_t levels;
+    uint32_t blockRows;
+
+    enum Side { BID = 0, ASK = 1 };
+
+    size_t timestamp_offset() const { return 8; }
+    size_t sequence_offset() const { return 8 + size_t(blockRows) * 8; }
+    size_t level_offset(int side, int level) const {
+        return 8 + size_t(blockRows) * 16 + size_t(side * levels + level) * blockRows * 16;
+    }
+    size_t price_offset(int side, int level) const { return level_offset(side, level); }
+    size_t quantity_offset(int side, int level) const { return level_offset(side, level) + size_t(blockRows) * 8; }
+    size_t orders_offset(int side, int level) const { return level_offset(side, level) + size_t(blockRows) * 12; }
+    size_t block_bytes() const { return level_offset(2, 0); }
+};
+
+// Samples top-of-book depth from the engine's book update stream every N events
+// and/or every T microseconds. The matching thread only copies the levels into
+// the current column block; full blocks are written by a background thread.
+class L2Exporter {
+public:
+    static constexpr int MAX_LEVELS = 20;
+    static constexpr uint32_t BLOCK_ROWS = 1024;
+
+    // everyEvents == 0 and everyMicros == 0 samples on every event
+    L2Exporter(const std::string& directory, int levels = 5, uint64_t everyEvents = 0, int64_t everyMicros = 0);
+    ~L2Exporter();
+
+    bool start();
+    void stop();
+
+    // Matching thread only
+    void on_book_update(const std::string& symbol, const OrderBook& book);
+
+    size_t get_snapshots_written() const { return snapshotsWritten.load(); }
+
+private:
+    struct SymbolState {
+        uint64_t events = 0;
+        int64_t lastSampleNs = 0;
+        uint32_t rows = 0;
+        std::vector<uint8_t> block;
+    };
+    struct PendingBlock {
+        std::string symbol;
+        std::vector<uint8_t> block;
+    };
+
+    std::string directory;
+    L2BlockLayout layout;
+    uint64_t everyEvents;
+    int64_t everyNs;
+
+    // Owned by the matching thread
+    std::unordered_map<std::string, SymbolState> symbols;
+    DepthLevel scratch[MAX_LEVELS];
+
+    // Hand-off to the writer thread; written blocks come back through freeBlocks
+    std::queue<PendingBlock> pending;
+    std::vector<std::vector<uint8_t>> freeBlocks;
+    std::mutex queueMutex;
+    std::condition_variable queueCondition;
+    std::thread writerThread;
+    std::atomic<bool> running;
+
+    // Owned by the writer thread
+    std::unordered_map<std::string, std::ofstream> files;
+    std::atomic<size_t> snapshotsWritten;
+
+    void capture(SymbolState& state, const OrderBook& book);
+    void submit_block(const std::string& symbol, SymbolState& state);
+    void writer_worker();
+    void write_block(PendingBlock& block);
+};
+
+// Read-only memory mapping of an .l2 file
+class L2SnapshotFile {
+public:
+    L2SnapshotFile() = default;
+    ~L2SnapshotFile();
+    L2SnapshotFile(const L2SnapshotFile&) = delete;
+    L2SnapshotFile& operator=(const L2SnapshotFile&) = delete;
+
+    bool open(const std::string& path);
+    void close();
+
+    const L2FileHeader& header() const { return *reinterpret_cast<const L2FileHeader*>(base); }
+    size_t block_count() const { return blockCount; }
+    uint32_t rows(size_t block) const { return *reinterpret_cast<const uint32_t*>(block_base(block)); }
+
+    const int64_t* timestamps(size_t block) const { return column<int64_t>(block, layout.timestamp_offset()); }
+    const uint64_t* sequences(size_t block) const { return column<uint64_t>(block, layout.sequence_offset()); }
+    const double* prices(size_t block, int side, int level) const { return column<double>(block, layout.price_offset(side, level)); }
+    const int32_t* quantities(size_t block, int side, int level) const { return column<int32_t>(block, layout.quantity_offset(side, level)); }
+    const int32_t* order_counts(size_t block, int side, int level) const { return column<int32_t>(block, layout.orders_offset(side, level)); }
+
+private:
+    const uint8_t* base = nullptr;
+    size_t mappedBytes = 0;
+    size_t blockCount = 0;
+    L2BlockLayout layout{0, 0};
+
+    const uint8_t* block_base(size_t block) const { return base + header().headerBytes + block * header().blockBytes; }
+    template <typename T>
+    const T* column(size_t block, size_t offset) const { return reinterpret_cast<const T*>(block_base(block) + offset); }
+};
+
+#endif
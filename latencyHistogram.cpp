@@ -0,0 +1,63 @@
+// latencyHistogram.cpp
+#include "latencyHistogram.hpp"
+#include <algorithm>
+#include <cmath>
+
+LatencyHistogram::LatencyHistogram() {
+    reset();
+}
+
+size_t LatencyHistogram::bucket_of(uint64_t ns) {
+    if (ns < static_cast<uint64_t>(SUB_BUCKETS)) return ns;
+
+    int exponent = 63 - __builtin_clzll(ns);
+    if (exponent > MAX_EXPONENT) return BUCKETS - 1;
+    size_t sub = (ns >> (exponent - SUB_BUCKET_BITS)) & (SUB_BUCKETS - 1);
+    return (exponent - SUB_BUCKET_BITS + 1) * SUB_BUCKETS + sub;
+}
+
+int64_t LatencyHistogram::bucket_upper(size_t bucket) {
+    if (bucket < static_cast<size_t>(SUB_BUCKETS)) return bucket;
+
+    int exponent = static_cast<int>(bucket / SUB_BUCKETS) + SUB_BUCKET_BITS - 1;
+    int64_t width = int64_t(1) << (exponent - SUB_BUCKET_BITS);
+    return (SUB_BUCKETS + static_cast<int64_t>(bucket % SUB_BUCKETS)) * width + width - 1;
+}
+
+void LatencyHistogram::record(int64_t ns) {
+    ns = std::max<int64_t>(ns, 0);
+    counts[bucket_of(ns)].fetch_add(1, std::memory_order_relaxed);
+    sum.fetch_add(ns, std::memory_order_relaxed);
+    total.fetch_add(1, std::memory_order_relaxed);
+
+    int64_t seen = maximum.load(std::memory_order_relaxed);
+    while (ns > seen && !maximum.compare_exchange_weak(seen, ns, std::memory_order_relaxed)) {
+    }
+}
+
+void LatencyHistogram::reset() {
+    for (auto& count : counts) {
+        count.store(0, std::memory_order_relaxed);
+    }
+    total.store(0, std::memory_order_relaxed);
+    sum.store(0, std::memory_order_relaxed);
+    maximum.store(0, std::memory_order_relaxed);
+}
+
+double LatencyHistogram::mean() const {
+    uint64_t n = count();
+    return n == 0 ? 0.0 : static_cast<double>(sum.load(std::memory_order_relaxed)) / n;
+}
+
+int64_t LatencyHistogram::percentile(double q) const {
+    uint64_t n = count();
+    if (n == 0) return 0;
+
+    uint64_t rank = std::max<uint64_t>(1, static_cast<uint64_t>(std::ceil(std::clamp(q, 0.0, 1.0) * n)));
+    uint64_t seen = 0;
+    for (size_t bucket = 0; bucket < BUCKETS; ++bucket) {
+        seen += counts[bucket].load(std::memory_order_relaxed);
+        if (seen >= rank) return std::min(bucket_upper(bucket), max());
+    }
+    return max();
+}
@@ -0,0 +1,43 @@
+// latencyHistogram.hpp
+#ifndef LATENCYHISTOGRAM_HPP
+#define LATENCYHISTOGRAM_HPP
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+
+// Log-linear latency histogram in nanoseconds: exact below 16ns, then 16
+// sub-buckets per power of two (about 6% resolution) up to roughly an hour.
+// Counters are relaxed atomics, so any thread may record while another reads;
+// a reader sees each sample either entirely or not at all.
+class LatencyHistogram {
+public:
+    static constexpr int SUB_BUCKET_BITS = 4;
+    static constexpr int SUB_BUCKETS = 1 << SUB_BUCKET_BITS;
+    static constexpr int MAX_EXPONENT = 42;
+    static constexpr size_t BUCKETS = (MAX_EXPONENT - SUB_BUCKET_BITS + 2) * SUB_BUCKETS;
+
+    LatencyHistogram();
+
+    // Negative samples (clock steps) count as zero
+    void record(int64_t ns);
+    void reset();
+
+    uint64_t count() const { return total.load(std::memory_order_relaxed); }
+    int64_t max() const { return maximum.load(std::memory_order_relaxed); }
+    double mean() const;
+
+    // Upper bound of the bucket holding the q-quantile (0 <= q <= 1); 0 if empty
+    int64_t percentile(double q) const;
+
+private:
+    std::atomic<uint64_t> counts[BUCKETS];
+    std::atomic<uint64_t> total;
+    std::atomic<uint64_t> sum;
+    std::atomic<int64_t> maximum;
+
+    static size_t bucket_of(uint64_t ns);
+    static int64_t bucket_upper(size_t bucket);
+};
+
+#endif
@@ -0,0 +1,341 @@
+// lobClient.cpp
+#include "lobClient.hpp"
+#include <algorithm>
+#include <cerrno>
+#include <charconv>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <iostream>
+#include <arpa/inet.h>
+#include <fcntl.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+namespace {
+
+// Longest encoded request; submit() rejects symbols that could overflow it
+constexpr size_t MAX_REQUEST = 256;
+
+// Value of "key" in one flat JSON line, without quotes; empty if absent
+std::string_view field(std::string_view line, std::string_view key) {
+    size_t pos = 0;
+    while ((pos = line.find(key, pos)) != std::string_view::npos) {
+        size_t colon = pos + key.size() + 1;
+        if (pos > 0 && line[pos - 1] == '"' && colon < line.size() && line[colon - 1] == '"' && line[colon] == ':') {
+            size_t begin = colon + 1;
+            if (begin < line.size() && line[begin] == '"') {
+                size_t end = line.find('"', begin + 1);
+                return end == std::string_view::npos ? std::string_view() : line.substr(begin + 1, end - begin - 1);
+            }
+            size_t end = line.find_first_of(",}]", begin);
+            return line.substr(begin, end == std::string_view::npos ? std::string_view::npos : end - begin);
+        }
+        pos += key.size();
+    }
+    return std::string_view();
+}
+
+template <typename T>
+T number(std::string_view text) {
+    T value = 0;
+    std::from_chars(text.data(), text.data() + text.size(), value);
+    return value;
+}
+
+// "ts":[received,sequenced,matched,sent]; zeros if the line has none
+void timestamps(std::string_view line, int64_t ts[4]) {
+    std::fill(ts, ts + 4, 0);
+    size_t pos = line.find("\"ts\":[");
+    if (pos == std::string_view::npos) return;
+
+    const char* cursor = line.data() + pos + 6;
+    const char* end = line.data() + line.size();
+    for (int i = 0; i < 4 && cursor < end; ++i) {
+        auto result = std::from_chars(cursor, end, ts[i]);
+        if (result.ec != std::errc()) return;
+        cursor = result.ptr + 1;
+    }
+}
+
+} // namespace
+
+LobClient::LobClient(Mode clientMode, size_t bufferBytes)
+    : mode(clientMode), fd(-1), nextRequestId(1),
+      sendBuffer(std::max(bufferBytes, MAX_REQUEST)), sendUsed(0),
+      recvBuffer(std::max<size_t>(bufferBytes, 4096)), recvUsed(0),
+      pendingIds(1024), pendingKinds(1024), pendingHead(0), pendingCount(0), dispatching(false) {}
+
+LobClient::~LobClient() {
+    disconnect();
+}
+
+bool LobClient::connect(const std::string& host, int port) {
+    disconnect();
+
+    int sock = socket(AF_INET, SOCK_STREAM, 0);
+    if (sock < 0) {
+        std::cerr << "Failed to create socket" << std::endl;
+        return false;
+    }
+
+    struct sockaddr_in address {};
+    address.sin_family = AF_INET;
+    address.sin_port = htons(port);
+    if (inet_pton(AF_INET, host.c_str(), &address.sin_addr) != 1 ||
+        ::connect(sock, (struct sockaddr*)&address, sizeof(address)) < 0) {
+        std::cerr << "Failed to connect to " << host << ":" << port << std::endl;
+        close(sock);
+        return false;
+    }
+
+    // Requests are already batched by flush(); Nagle would only delay the last one
+    int one = 1;
+    setsockopt(sock, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+    fcntl(sock, F_SETFL, fcntl(sock, F_GETFL) | O_NONBLOCK);
+
+    fd = sock;
+    sendUsed = 0;
+    recvUsed = 0;
+    pendingHead = 0;
+    pendingCount = 0;
+    return true;
+}
+
+void LobClient::disconnect() {
+    if (fd >= 0) {
+        close(fd);
+        fd = -1;
+    }
+}
+
+uint64_t LobClient::submit(OrderType side, double price, int quantity, const std::string& symbol) {
+    if (symbol.size() > MAX_REQUEST / 2) return 0;
+    char* out = reserve(MAX_REQUEST);
+    if (!out) return 0;
+
+    int length = std::snprintf(out, MAX_REQUEST,
+                               "{\"type\":\"submit_order\",\"clOrdId\":\"c%llu\",\"orderType\":\"%s\","
+                               "\"price\":%.10g,\"quantity\":%d,\"symbol\":\"%s\"}\n",
+                               static_cast<unsigned long long>(nextRequestId), side == BUY ? "BUY" : "SELL",
+                               price, quantity, symbol.c_str());
+    return enqueue(Pending::SUBMIT, length);
+}
+
+uint64_t LobClient::cancel(uint64_t submitRequestId) {
+    char* out = reserve(MAX_REQUEST);
+    if (!out) return 0;
+
+    int length = std::snprintf(out, MAX_REQUEST, "{\"type\":\"cancel_order\",\"clOrdId\":\"c%llu\"}\n",
+                               static_cast<unsigned long long>(submitRequestId));
+    return enqueue(Pending::CANCEL, length);
+}
+
+uint64_t LobClient::modify(uint64_t submitRequestId, double price, int quantity) {
+    char* out = reserve(MAX_REQUEST);
+    if (!out) return 0;
+
+    int length = std::snprintf(out, MAX_REQUEST,
+                               "{\"type\":\"modify_order\",\"clOrdId\":\"c%llu\",\"price\":%.10g,\"quantity\":%d}\n",
+                               static_cast<unsigned long long>(submitRequestId), price, quantity);
+    return enqueue(Pending::MODIFY, length);
+}
+
+bool LobClient::set_timestamps(bool enabled) {
+    char* out = reserve(MAX_REQUEST);
+    if (!out) return false;
+
+    int length = std::snprintf(out, MAX_REQUEST, "{\"type\":\"set_timestamps\",\"enabled\":%s}\n",
+                               enabled ? "true" : "false");
+    return enqueue(Pending::CONTROL, length) != 0;
+}
+
+char* LobClient::reserve(size_t bytes) {
+    if (fd < 0) return nullptr;
+    if (sendBuffer.size() - sendUsed < bytes && !flush()) return nullptr;
+    return sendBuffer.data() + sendUsed;
+}
+
+uint64_t LobClient::enqueue(Pending kind, size_t length) {
+    uint64_t requestId = nextRequestId++;
+    sendUsed += length;
+    push_pending(requestId, kind);
+    return requestId;
+}
+
+void LobClient::push_pending(uint64_t requestId, Pending kind) {
+    if (pendingCount == pendingIds.size()) {
+        // Unroll the ring into twice the room
+        std::vector<uint64_t> ids(pendingIds.size() * 2);
+        std::vector<Pending> kinds(pendingKinds.size() * 2);
+        for (size_t i = 0; i < pendingCount; ++i) {
+            size_t slot = (pendingHead + i) % pendingIds.size();
+            ids[i] = pendingIds[slot];
+            kinds[i] = pendingKinds[slot];
+        }
+        pendingIds.swap(ids);
+        pendingKinds.swap(kinds);
+        pendingHead = 0;
+    }
+
+    size_t slot = (pendingHead + pendingCount) % pendingIds.size();
+    pendingIds[slot] = requestId;
+    pendingKinds[slot] = kind;
+    pendingCount++;
+}
+
+bool LobClient::flush() {
+    while (sendUsed > 0) {
+        if (!write_some()) {
+            fail();
+            return false;
+        }
+        if (sendUsed == 0) break;
+
+        // The socket is full. Keep reading so the gateway never blocks sending
+        // to us, except from inside a callback, where the receive buffer is in use.
+        if (mode == BUSY_POLL) {
+            if (!dispatching && read_some() < 0) {
+                fail();
+                return false;
+            }
+            continue;
+        }
+        struct pollfd pfd = {fd, static_cast<short>(dispatching ? POLLOUT : POLLOUT | POLLIN), 0};
+        if (::poll(&pfd, 1, -1) < 0 && errno != EINTR) {
+            fail();
+            return false;
+        }
+        if (!dispatching && (pfd.revents & (POLLIN | POLLHUP | POLLERR)) && read_some() < 0) {
+            fail();
+            return false;
+        }
+    }
+    return fd >= 0;
+}
+
+int LobClient::poll(int timeoutMs) {
+    if (fd < 0 || !flush()) return -1;
+
+    int handled = handle_lines();
+    auto deadline = std::chrono::steady_clock::now() + std::chrono::milliseconds(std::max(timeoutMs, 0));
+    while (fd >= 0) {
+        int received = read_some();
+        if (received < 0) {
+            fail();
+            break;
+        }
+        if (received > 0) {
+            handled += handle_lines();
+            continue;
+        }
+        if (handled > 0 || timeoutMs == 0) break;
+
+        int waitMs = -1;
+        if (timeoutMs > 0) {
+            auto remaining = std::chrono::duration_cast<std::chrono::milliseconds>(deadline - std::chrono::steady_clock::now());
+            if (remaining.count() <= 0) break;
+            waitMs = static_cast<int>(remaining.count());
+        }
+        if (mode == BLOCKING) {
+            struct pollfd pfd = {fd, POLLIN, 0};
+            ::poll(&pfd, 1, waitMs);
+        }
+    }
+    return (handled == 0 && fd < 0) ? -1 : handled;
+}
+
+bool LobClient::write_some() {
+    ssize_t sent = send(fd, sendBuffer.data(), sendUsed, MSG_NOSIGNAL | MSG_DONTWAIT);
+    if (sent < 0) {
+        return errno == EAGAIN || errno == EWOULDBLOCK || errno == EINTR;
+    }
+    std::memmove(sendBuffer.data(), sendBuffer.data() + sent, sendUsed - sent);
+    sendUsed -= sent;
+    return true;
+}
+
+int LobClient::read_some() {
+    if (recvBuffer.size() - recvUsed < 4096) {
+        recvBuffer.resize(recvBuffer.size() * 2);
+    }
+
+    ssize_t received = recv(fd, recvBuffer.data() + recvUsed, recvBuffer.size() - recvUsed, MSG_DONTWAIT);
+    if (received > 0) {
+        recvUsed += received;
+        return static_cast<int>(received);
+    }
+    if (received < 0 && (errno == EAGAIN || errno == EWOULDBLOCK || errno == EINTR)) return 0;
+    return -1;
+}
+
+int LobClient::handle_lines() {
+    int handled = 0;
+    size_t start = 0;
+    dispatching = true;
+    while (start < recvUsed) {
+        const char* begin = recvBuffer.data() + start;
+        const char* newline = static_cast<const char*>(std::memchr(begin, '\n', recvUsed - start));
+        if (!newline) break;
+
+        handle_line(std::string_view(begin, newline - begin));
+        start += newline - begin + 1;
+        handled++;
+    }
+    dispatching = false;
+
+    std::memmove(recvBuffer.data(), recvBuffer.data() + start, recvUsed - start);
+    recvUsed -= start;
+    return handled;
+}
+
+void LobClient::handle_line(std::string_view line) {
+    std::string_view type = field(line, "type");
+
+    if (type == "execution") {
+        if (!executionCallback) return;
+        ExecutionView execution;
+        execution.executionId = field(line, "executionId");
+        execution.orderId = field(line, "orderId");
+        execution.symbol = field(line, "symbol");
+        execution.side = field(line, "side") == "SELL" ? SELL : BUY;
+        execution.filledQuantity = number<int>(field(line, "filledQuantity"));
+        execution.remainingQuantity = number<int>(field(line, "remainingQuantity"));
+        execution.averagePrice = number<double>(field(line, "averagePrice"));
+        execution.worstPrice = number<double>(field(line, "worstPrice"));
+        timestamps(line, execution.ts);
+        executionCallback(execution);
+        return;
+    }
+
+    // Everything else the gateway answers a request with comes back in order;
+    // unsolicited messages (welcome, trades, book updates) are skipped
+    bool response = type == "order_submitted" || type == "order_cancelled" || type == "order_modified" ||
+                    type == "error" || type == "timestamps";
+    if (!response || pendingCount == 0) return;
+
+    uint64_t requestId = pendingIds[pendingHead];
+    Pending kind = pendingKinds[pendingHead];
+    pendingHead = (pendingHead + 1) % pendingIds.size();
+    pendingCount--;
+    if (kind == Pending::CONTROL || !ackCallback) return;
+
+    OrderAck ack;
+    ack.requestId = requestId;
+    ack.kind = (kind == Pending::SUBMIT) ? OrderAck::SUBMITTED :
+               (kind == Pending::CANCEL) ? OrderAck::CANCELLED : OrderAck::MODIFIED;
+    ack.accepted = type != "error" && field(line, "status") == "success";
+    ack.orderId = field(line, "orderId");
+    ack.clOrdId = field(line, "clOrdId");
+    ack.message = field(line, "message");
+    timestamps(line, ack.ts);
+    ackCallback(ack);
+}
+
+void LobClient::fail() {
+    disconnect();
+    sendUsed = 0;
+}
@@ -0,0 +1,125 @@
+// lobClient.hpp
+#ifndef LOBCLIENT_HPP
+#define LOBCLIENT_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <string_view>
+#include <vector>
+#include "order.hpp"
+
+// Response to one submit, cancel or modify, in the order they were sent.
+// Views point into the client's receive buffer and are valid only for the
+// duration of the callback.
+struct OrderAck {
+    enum Kind { SUBMITTED, CANCELLED, MODIFIED };
+
+    uint64_t requestId;          // returned by submit/cancel/modify
+    Kind kind;                   // what the request was
+    bool accepted;               // false for a gateway error or a failed cancel/modify
+    std::string_view orderId;    // engine order id; empty on error
+    std::string_view clOrdId;    // ClOrdID of the order the request refers to
+    std::string_view message;    // error text; empty otherwise
+    int64_t ts[4];               // gateway received/sequenced/matched/sent, 0 unless timestamps are on
+};
+
+// One execution report. The gateway broadcasts every execution to every
+// session, so orderId (the aggressor) may belong to another client.
+struct ExecutionView {
+    std::string_view executionId;
+    std::string_view orderId;
+    std::string_view symbol;
+    OrderType side;
+    int filledQuantity;
+    int remainingQuantity;
+    double averagePrice;
+    double worstPrice;
+    int64_t ts[4];               // set on executions this session caused, with timestamps on
+};
+
+// Client for the gateway's order entry protocol (newline-delimited JSON over
+// TCP, see SimpleServer). Requests are encoded into a preallocated send buffer
+// and go out on flush() or when the buffer fills, so any number can be in
+// flight; every order gets a ClOrdID derived from its request id, which lets a
+// cancel or modify be pipelined behind the submit before its ack arrives.
+// Responses are parsed in place and handed to the callbacks without copies;
+// callbacks run inside poll() and may queue requests, but must not call poll().
+//
+// BLOCKING waits in poll(2) for data; BUSY_POLL spins on non-blocking reads,
+// trading a core for the wakeup latency. Not thread-safe: one thread drives a
+// client.
+class LobClient {
+public:
+    enum Mode { BLOCKING, BUSY_POLL };
+
+    using AckCallback = std::function<void(const OrderAck&)>;
+    using ExecutionCallback = std::function<void(const ExecutionView&)>;
+
+    explicit LobClient(Mode mode = BLOCKING, size_t bufferBytes = 65536);
+    ~LobClient();
+    LobClient(const LobClient&) = delete;
+    LobClient& operator=(const LobClient&) = delete;
+
+    bool connect(const std::string& host, int port);
+    void disconnect();
+    bool connected() const { return fd >= 0; }
+
+    void on_ack(AckCallback callback) { ackCallback = std::move(callback); }
+    void on_execution(ExecutionCallback callback) { executionCallback = std::move(callback); }
+
+    // Queue a request and return its id, or 0 if the client is disconnected.
+    // cancel/modify refer to an earlier submit by its request id.
+    uint64_t submit(OrderType side, double price, int quantity, const std::string& symbol = "DEFAULT");
+    uint64_t cancel(uint64_t submitRequestId);
+    uint64_t modify(uint64_t submitRequestId, double price, int quantity);
+
+    // Ask the gateway to stamp this session's acks and fills (user-space
+    // stage times). Its reply is consumed internally.
+    bool set_timestamps(bool enabled);
+
+    // Write every queued request; false if the connection failed
+    bool flush();
+
+    // Flush, then handle whatever responses arrive within timeoutMs (0 only
+    // drains what is already there, negative waits for at least one read).
+    // Returns the number of messages handled, or -1 once disconnected.
+    int poll(int timeoutMs = 0);
+
+    // Requests sent or queued that have not been answered yet
+    size_t outstanding() const { return pendingCount; }
+
+private:
+    enum class Pending : uint8_t { SUBMIT, CANCEL, MODIFY, CONTROL };
+
+    Mode mode;
+    int fd;
+    uint64_t nextRequestId;
+
+    std::vector<char> sendBuffer;
+    size_t sendUsed;
+    std::vector<char> recvBuffer;
+    size_t recvUsed;
+
+    // Ring of unanswered requests; the gateway answers each in order
+    std::vector<uint64_t> pendingIds;
+    std::vector<Pending> pendingKinds;
+    size_t pendingHead;
+    size_t pendingCount;
+    bool dispatching;
+
+    AckCallback ackCallback;
+    ExecutionCallback executionCallback;
+
+    char* reserve(size_t bytes);
+    uint64_t enqueue(Pending kind, size_t length);
+    void push_pending(uint64_t requestId, Pending kind);
+    bool write_some();
+    int read_some();
+    int handle_lines();
+    void handle_line(std::string_view line);
+    void fail();
+};
+
+#endif
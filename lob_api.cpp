@@ -0,0 +1,201 @@
+// lob_api.cpp
+#include "lob_api.h"
+#include "matchingEngine.hpp"
+#include <algorithm>
+#include <cstring>
+#include <new>
+#include <string>
+#include <vector>
+
+struct lob_engine {
+    MatchingEngine engine;
+    InstrumentMaster instruments;
+    std::vector<lob_event> events;
+    size_t head = 0;
+    // Symbol of the last order and its ID, so a run of orders for one symbol
+    // resolves it once
+    char symbol[LOB_SYMBOL_LEN] = {};
+    uint32_t symbolId = InstrumentMaster::INVALID_SYMBOL_ID;
+};
+
+namespace {
+
+// Engine order and trade IDs are a one-letter prefix followed by a decimal number
+uint64_t numeric_id(const std::string& id) {
+    uint64_t value = 0;
+    for (char c : id) {
+        if (c >= '0' && c <= '9') value = value * 10 + static_cast<uint64_t>(c - '0');
+    }
+    return value;
+}
+
+std::string engine_order_id(uint64_t orderId) {
+    return "O" + std::to_string(orderId);
+}
+
+std::string fixed_string(const char* data, size_t maxLen) {
+    return std::string(data, strnlen(data, maxLen));
+}
+
+int64_t to_ns(std::chrono::system_clock::time_point tp) {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(tp.time_since_epoch()).count();
+}
+
+lob_event make_event(lob_event_type type, uint64_t orderId, double price, int32_t quantity) {
+    lob_event event{};
+    event.type = type;
+    event.order_id = orderId;
+    event.price = price;
+    event.quantity = quantity;
+    event.timestamp_ns = to_ns(std::chrono::system_clock::now());
+    return event;
+}
+
+} // namespace
+
+extern "C" {
+
+uint32_t lob_api_version(void) {
+    return LOB_API_VERSION;
+}
+
+lob_engine* lob_engine_create(void) {
+    try {
+        lob_engine* handle = new lob_engine();
+        handle->engine.set_execution_callback([handle](const ExecutionReport& report) {
+            uint64_t executionId = numeric_id(report.executionId);
+            uint64_t aggressorId = numeric_id(report.orderId);
+            int64_t timestamp = to_ns(report.timestamp);
+
+            lob_event summary{};
+            summary.type = LOB_EVENT_EXECUTION;
+            summary.order_id = aggressorId;
+            summary.trade_id = executionId;
+            summary.price = report.averagePrice;
+            summary.quantity = report.filledQuantity;
+            summary.timestamp_ns = timestamp;
+            handle->events.push_back(summary);
+
+            for (const auto& fill : report.fills) {
+                uint64_t passiveId = numeric_id(fill.passiveOrderId);
+                lob_event event{};
+                event.type = LOB_EVENT_TRADE;
+                event.order_id = (report.side == BUY) ? aggressorId : passiveId;
+                event.contra_order_id = (report.side == BUY) ? passiveId : aggressorId;
+                event.trade_id = executionId;
+                event.price = fill.price;
+                event.quantity = fill.quantity;
+                event.timestamp_ns = timestamp;
+                handle->events.push_back(event);
+            }
+        });
+        return handle;
+    } catch (...) {
+        return nullptr;
+    }
+}
+
+void lob_engine_destroy(lob_engine* engine) {
+    delete engine;
+}
+
+int lob_engine_load_instruments(lob_engine* engine, const char* path) {
+    if (!engine || !path) return LOB_ERR_INVALID;
+
+    try {
+        InstrumentMaster instruments;
+        if (!instruments.load(path)) return LOB_ERR_INVALID;
+        engine->instruments = std::move(instruments);
+        engine->engine.set_instrument_master(&engine->instruments);
+        engine->symbolId = engine->engine.symbol_id(fixed_string(engine->symbol, LOB_SYMBOL_LEN));
+        return LOB_OK;
+    } catch (...) {
+        return LOB_ERR_INTERNAL;
+    }
+}
+
+int lob_submit(lob_engine* engine, const lob_order_request* request, uint64_t* order_id) {
+    if (!engine || !request) return LOB_ERR_INVALID;
+    if (request->side != LOB_SIDE_BUY && request->side != LOB_SIDE_SELL) return LOB_ERR_INVALID;
+
+    try {
+        // Trades generated while matching are appended during submit_order;
+        // the acceptance must precede them in the event stream.
+        std::string symbol = fixed_string(request->symbol, LOB_SYMBOL_LEN);
+        if (std::memcmp(request->symbol, engine->symbol, LOB_SYMBOL_LEN) != 0) {
+            std::memcpy(engine->symbol, request->symbol, LOB_SYMBOL_LEN);
+            engine->symbolId = engine->engine.symbol_id(symbol);
+        }
+
+        size_t acceptedAt = engine->events.size();
+        std::string orderId = engine->engine.submit_order(
+            request->side == LOB_SIDE_BUY ? BUY : SELL, request->price, request->quantity,
+            symbol, engine->symbolId, fixed_string(request->client_id, LOB_CLIENT_ID_LEN));
+        if (orderId.empty()) return LOB_ERR_INVALID;
+
+        uint64_t id = numeric_id(orderId);
+        engine->events.insert(engine->events.begin() + acceptedAt,
+                              make_event(LOB_EVENT_ACCEPTED, id, request->price, request->quantity));
+        if (order_id) *order_id = id;
+        return LOB_OK;
+    } catch (...) {
+        return LOB_ERR_INTERNAL;
+    }
+}
+
+int lob_cancel(lob_engine* engine, uint64_t order_id) {
+    if (!engine) return LOB_ERR_INVALID;
+
+    try {
+        auto order = engine->engine.get_order(engine_order_id(order_id));
+        if (!order || !engine->engine.cancel_order(order->orderId)) return LOB_ERR_NOT_FOUND;
+
+        engine->events.push_back(make_event(LOB_EVENT_CANCELLED, order_id, order->price,
+                                            order->getRemainingQuantity()));
+        return LOB_OK;
+    } catch (...) {
+        return LOB_ERR_INTERNAL;
+    }
+}
+
+int lob_modify(lob_engine* engine, uint64_t order_id, double price, int32_t quantity) {
+    if (!engine || price <= 0 || quantity <= 0) return LOB_ERR_INVALID;
+
+    try {
+        size_t modifiedAt = engine->events.size();
+        if (!engine->engine.modify_order(engine_order_id(order_id), price, quantity)) {
+            return LOB_ERR_NOT_FOUND;
+        }
+        engine->events.insert(engine->events.begin() + modifiedAt,
+                              make_event(LOB_EVENT_MODIFIED, order_id, price, quantity));
+        return LOB_OK;
+    } catch (...) {
+        return LOB_ERR_INTERNAL;
+    }
+}
+
+size_t lob_poll_events(lob_engine* engine, lob_event* events, size_t capacity) {
+    if (!engine || !events) return 0;
+
+    size_t count = std::min(capacity, engine->events.size() - engine->head);
+    if (count > 0) {
+        std::memcpy(events, engine->events.data() + engine->head, count * sizeof(lob_event));
+        engine->head += count;
+    }
+
+    // Reuse the buffer once the caller has drained it
+    if (engine->head == engine->events.size()) {
+        engine->events.clear();
+        engine->head = 0;
+    }
+    return count;
+}
+
+int lob_top_of_book(lob_engine* engine, double* best_bid, double* best_ask) {
+    if (!engine) return LOB_ERR_INVALID;
+    if (best_bid) *best_bid = engine->engine.get_best_bid();
+    if (best_ask) *best_ask = engine->engine.get_best_ask();
+    return LOB_OK;
+}
+
+} // extern "C"
@@ -0,0 +1,99 @@
+/* lob_api.h - C interface to the embeddable matching core (liblob) */
+#ifndef LOB_API_H
+#define LOB_API_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*
+ * The structs below are part of the ABI: fields are only ever appended
+ * into the reserved space, never reordered or resized. Bump
+ * LOB_API_VERSION whenever a reserved field gains a meaning.
+ *
+ * Version 2: LOB_EVENT_EXECUTION was added, and trade_id identifies the
+ * whole sweep of an aggressive order, shared by all of its events; in
+ * version 1 every LOB_EVENT_TRADE had a trade_id of its own.
+ */
+#define LOB_API_VERSION 2
+
+#define LOB_SYMBOL_LEN 16
+#define LOB_CLIENT_ID_LEN 16
+
+typedef struct lob_engine lob_engine;
+
+typedef enum {
+    LOB_SIDE_BUY = 0,
+    LOB_SIDE_SELL = 1
+} lob_side;
+
+typedef enum {
+    LOB_OK = 0,
+    LOB_ERR_INVALID = -1,
+    LOB_ERR_NOT_FOUND = -2,
+    LOB_ERR_INTERNAL = -3
+} lob_status;
+
+typedef enum {
+    LOB_EVENT_ACCEPTED = 1,
+    LOB_EVENT_TRADE = 2,
+    LOB_EVENT_CANCELLED = 3,
+    LOB_EVENT_MODIFIED = 4,
+    LOB_EVENT_EXECUTION = 5
+} lob_event_type;
+
+/* New order. symbol and client_id are NUL-padded, not necessarily terminated. */
+typedef struct {
+    int32_t side;
+    int32_t quantity;
+    double price;
+    char symbol[LOB_SYMBOL_LEN];
+    char client_id[LOB_CLIENT_ID_LEN];
+    uint32_t flags;
+    uint32_t reserved[3];
+} lob_order_request;
+
+/*
+ * Engine event. An aggressive order that trades produces one
+ * LOB_EVENT_EXECUTION (aggressor order_id, total quantity, average price)
+ * followed by one LOB_EVENT_TRADE per passive fill, all sharing trade_id.
+ * For LOB_EVENT_TRADE order_id is the buy order and contra_order_id the
+ * sell order; for every other type contra_order_id is zero.
+ */
+typedef struct {
+    int32_t type;
+    int32_t quantity;
+    uint64_t order_id;
+    uint64_t contra_order_id;
+    uint64_t trade_id;
+    double price;
+    int64_t timestamp_ns;
+    uint32_t reserved[4];
+} lob_event;
+
+uint32_t lob_api_version(void);
+
+/* An engine must only be used from one thread at a time. */
+lob_engine* lob_engine_create(void);
+void lob_engine_destroy(lob_engine* engine);
+
+/* Loads instrument reference data (CSV or binary); afterwards orders are tick/lot/band checked. */
+int lob_engine_load_instruments(lob_engine* engine, const char* path);
+
+int lob_submit(lob_engine* engine, const lob_order_request* request, uint64_t* order_id);
+int lob_cancel(lob_engine* engine, uint64_t order_id);
+int lob_modify(lob_engine* engine, uint64_t order_id, double price, int32_t quantity);
+
+/* Copies up to capacity pending events into events and returns how many were copied. */
+size_t lob_poll_events(lob_engine* engine, lob_event* events, size_t capacity);
+
+int lob_top_of_book(lob_engine* engine, double* best_bid, double* best_ask);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* LOB_API_H */
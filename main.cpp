@@ -1,37 +1,321 @@
 #include "matchingEngine.hpp"
 #include "dataInterface.hpp"
 #include "simple_server.hpp"
+#include "instrument.hpp"
+#include "tradeTape.hpp"
+#include "l2Exporter.hpp"
+#include "flowToxicity.hpp"
+#include "journal.hpp"
+#include "warmup.hpp"
+#include "sessionCapture.hpp"
 #include <iostream>
+#include <iomanip>
 #include <thread>
 #include <chrono>
 #include <atomic>
+#include <mutex>
+#include <unordered_map>
 
-int main() {
+int main(int argc, char* argv[]) {
     std::cout << "=== Limit Order Book Trading System ===" << std::endl;
     
+    std::string instrumentFile;
+    double hotWindow = 0.0;
+    std::string tapeDirectory;
+    std::string l2Directory;
+    int l2Levels = 5;
+    uint64_t l2EveryEvents = 0;
+    int64_t l2EveryMicros = 0;
+    std::vector<std::string> followFiles;
+    std::string followOffsets;
+    std::string ingestSource;
+    unsigned ingestThreads = 0;
+    int64_t vpinBucket = 0;
+    uint32_t vpinWindow = 50;
+    double vpinThreshold = 0.0;
+    std::string journalFile;
+    JournalEncoding journalEncoding = JOURNAL_COMPACT;
+    std::string replayJournal;
+    unsigned replayThreads = 0;
+    int64_t warmupMs = 0;
+    std::string captureFile;
+    bool kernelTimestamps = false;
+    bool slotOrderIds = false;
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        if (arg == "--instruments" && i + 1 < argc) {
+            instrumentFile = argv[++i];
+        } else if (arg == "--hot-window" && i + 1 < argc) {
+            hotWindow = std::stod(argv[++i]);
+        } else if (arg == "--tape-dir" && i + 1 < argc) {
+            tapeDirectory = argv[++i];
+        } else if (arg == "--l2-dir" && i + 1 < argc) {
+            l2Directory = argv[++i];
+        } else if (arg == "--l2-levels" && i + 1 < argc) {
+            l2Levels = std::stoi(argv[++i]);
+        } else if (arg == "--l2-every-events" && i + 1 < argc) {
+            l2EveryEvents = std::stoull(argv[++i]);
+        } else if (arg == "--l2-every-us" && i + 1 < argc) {
+            l2EveryMicros = std::stoll(argv[++i]);
+        } else if (arg == "--follow" && i + 1 < argc) {
+            followFiles.push_back(argv[++i]);
+        } else if (arg == "--follow-offsets" && i + 1 < argc) {
+            followOffsets = argv[++i];
+        } else if (arg == "--ingest" && i + 1 < argc) {
+            ingestSource = argv[++i];
+        } else if (arg == "--ingest-threads" && i + 1 < argc) {
+            ingestThreads = std::stoul(argv[++i]);
+        } else if (arg == "--vpin-bucket" && i + 1 < argc) {
+            vpinBucket = std::stoll(argv[++i]);
+        } else if (arg == "--vpin-window" && i + 1 < argc) {
+            vpinWindow = std::stoul(argv[++i]);
+        } else if (arg == "--vpin-threshold" && i + 1 < argc) {
+            vpinThreshold = std::stod(argv[++i]);
+        } else if (arg == "--journal" && i + 1 < argc) {
+            journalFile = argv[++i];
+        } else if (arg == "--journal-encoding" && i + 1 < argc) {
+            journalEncoding = (std::string(argv[++i]) == "fixed") ? JOURNAL_FIXED : JOURNAL_COMPACT;
+        } else if (arg == "--replay-journal" && i + 1 < argc) {
+            replayJournal = argv[++i];
+        } else if (arg == "--replay-threads" && i + 1 < argc) {
+            replayThreads = std::stoul(argv[++i]);
+        } else if (arg == "--warmup-ms" && i + 1 < argc) {
+            warmupMs = std::stoll(argv[++i]);
+        } else if (arg == "--capture" && i + 1 < argc) {
+            captureFile = argv[++i];
+        } else if (arg == "--kernel-timestamps") {
+            kernelTimestamps = true;
+        } else if (arg == "--slot-order-ids") {
+            slotOrderIds = true;
+        } else {
+            std::cerr << "Usage: " << argv[0] << " [--instruments <file.csv|file.bin>]"
+                      << " [--hot-window <price distance>] [--tape-dir <dir>]"
+                      << " [--l2-dir <dir> [--l2-levels K] [--l2-every-events N] [--l2-every-us T]]"
+                      << " [--follow <file.csv|file.jsonl> ... [--follow-offsets <file>]]"
+                      << " [--ingest <dir|manifest> [--ingest-threads N]]"
+                      << " [--vpin-bucket V [--vpin-window N] [--vpin-threshold X]]"
+                      << " [--journal <file> [--journal-encoding fixed|compact]]"
+                      << " [--replay-journal <file> [--replay-threads N]] [--warmup-ms T]"
+                      << " [--capture <file>] [--kernel-timestamps] [--slot-order-ids]" << std::endl;
+            return 1;
+        }
+    }
+    
     MatchingEngine engine;
+    InstrumentMaster instruments;
+    if (!instrumentFile.empty()) {
+        std::string error;
+        if (!instruments.load(instrumentFile, &error)) {
+            std::cerr << "Failed to load instruments: " << error << std::endl;
+            return 1;
+        }
+        engine.set_instrument_master(&instruments);
+        std::cout << "Loaded " << instruments.size() << " instruments from " << instrumentFile << std::endl;
+    }
+    if (hotWindow > 0) {
+        engine.set_hot_window(hotWindow);
+    }
+    engine.set_slot_order_ids(slotOrderIds);
+    
+    // Historical replay: one book per symbol, configured like the live engine and
+    // matched in parallel. Only the totals are reported; the books are separate
+    // from the live engine and dropped afterwards.
+    if (!ingestSource.empty()) {
+        IngestStats stats = DataInterface::ingest_parallel(ingestSource, ingestThreads, nullptr,
+                                                           instruments.empty() ? nullptr : &instruments,
+                                                           hotWindow, slotOrderIds);
+        std::cout << "Ingested " << stats.files << " files, " << stats.symbols << " symbols, "
+                  << stats.orders << " orders (" << stats.rejected << " rejected orders, "
+                  << stats.parseErrors << " unparsable lines) in "
+                  << std::fixed << std::setprecision(2) << stats.seconds << "s: "
+                  << stats.trades << " trades, notional " << stats.volume << std::endl;
+    }
+    
+    // Rebuild the book from a command journal; blocks are decoded in parallel and
+    // applied in order. Journaled order IDs are mapped to the IDs assigned now.
+    if (!replayJournal.empty()) {
+        JournalReader reader;
+        if (!reader.open(replayJournal)) {
+            return 1;
+        }
+        auto start = std::chrono::steady_clock::now();
+        std::vector<JournalRecord> records = reader.read_all(replayThreads);
+        std::unordered_map<uint64_t, std::string> replayedIds;
+        size_t applied = 0;
+        for (const auto& record : records) {
+            if (record.command == JOURNAL_NEW) {
+                std::string orderId = engine.submit_order(static_cast<OrderType>(record.side), record.price,
+                                                          record.quantity, record.symbol);
+                if (!orderId.empty()) {
+                    replayedIds[record.orderId] = orderId;
+                    applied++;
+                }
+                continue;
+            }
+            auto it = replayedIds.find(record.orderId);
+            if (it == replayedIds.end()) continue;
+            bool ok = (record.command == JOURNAL_CANCEL) ? engine.cancel_order(it->second)
+                                                         : engine.modify_order(it->second, record.price, record.quantity);
+            applied += ok ? 1 : 0;
+        }
+        double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        std::cout << "Replayed " << applied << " of " << records.size() << " journaled commands from "
+                  << reader.get_block_count() << " blocks in " << std::fixed << std::setprecision(2)
+                  << seconds << "s" << std::endl;
+    }
+    
     DataInterface dataInterface(engine);
     SimpleServer server;
     
+    // The engine is single-threaded; gateway sessions, follow mode and the
+    // simulation each call it from their own threads under this mutex
+    std::mutex engineMutex;
+    dataInterface.set_engine_mutex(&engineMutex);
+    
+    // Every command the engine accepts is journaled, whether it came from a
+    // client, the demo orders, the simulation or follow mode; encoding and disk
+    // writes happen on the journal's writer thread
+    std::unique_ptr<CommandJournal> journal;
+    if (!journalFile.empty()) {
+        journal.reset(new CommandJournal(journalFile, journalEncoding));
+        if (!journal->start()) {
+            return 1;
+        }
+        engine.set_command_callback([&journal](EngineCommand command, const Order& order) {
+            switch (command) {
+            case COMMAND_NEW:
+                journal->record_new(order.orderId, order.symbol, order.type, order.price, order.quantity);
+                break;
+            case COMMAND_CANCEL:
+                journal->record_cancel(order.orderId, order.symbol);
+                break;
+            case COMMAND_MODIFY:
+                journal->record_modify(order.orderId, order.symbol, order.price, order.quantity);
+                break;
+            }
+        });
+        std::cout << "Journaling commands to " << journalFile << " ("
+                  << (journalEncoding == JOURNAL_FIXED ? "fixed" : "compact") << ")" << std::endl;
+    }
+    
+    // Raw inbound bytes of every client session, for capture_replay
+    std::unique_ptr<SessionCapture> capture;
+    if (!captureFile.empty()) {
+        capture.reset(new SessionCapture(captureFile));
+        if (!capture->start()) {
+            return 1;
+        }
+        server.set_session_capture(capture.get());
+        std::cout << "Capturing client sessions to " << captureFile << std::endl;
+    }
+    
+    // Kernel receive and transmit times on client sockets split gateway latency
+    // into socket queuing, engine and send path
+    if (kernelTimestamps) {
+        server.set_kernel_timestamping(true);
+    }
+    
     // Set up server callbacks
-    server.set_matching_engine_callback([&engine](OrderType type, double price, int quantity, const std::string& symbol, const std::string& clientId) {
-        return engine.submit_order(type, price, quantity, symbol, clientId);
+    server.set_symbol_resolver([&engine](const std::string& symbol) {
+        return engine.symbol_id(symbol);
+    });
+    server.set_matching_engine_callback([&engine, &engineMutex](OrderType type, double price, int quantity, const std::string& symbol, uint32_t symbolId, const std::string& clientId) {
+        std::lock_guard<std::mutex> lock(engineMutex);
+        return engine.submit_order(type, price, quantity, symbol, symbolId, clientId);
     });
     
-    server.set_cancel_callback([&engine](const std::string& orderId) {
+    server.set_cancel_callback([&engine, &engineMutex](const std::string& orderId) {
+        std::lock_guard<std::mutex> lock(engineMutex);
         return engine.cancel_order(orderId);
     });
     
-    // Set up trade callback for real-time updates
-    engine.set_trade_callback([&server](const Trade& trade) {
-        std::cout << "Trade executed: " << trade.quantity << " @ " 
-                  << std::fixed << std::setprecision(2) << trade.price 
-                  << " (Trade ID: " << trade.tradeId << ")" << std::endl;
+    server.set_modify_callback([&engine, &engineMutex](const std::string& orderId, double price, int quantity) {
+        std::lock_guard<std::mutex> lock(engineMutex);
+        return engine.modify_order(orderId, price, quantity);
+    });
+    
+    // Trade archive for research, written in the background
+    std::unique_ptr<TradeTapeWriter> tape;
+    if (!tapeDirectory.empty()) {
+        tape.reset(new TradeTapeWriter(tapeDirectory, 0.01, &instruments));
+        if (!tape->start()) {
+            return 1;
+        }
+        std::cout << "Archiving trades to " << tapeDirectory << std::endl;
+    }
+    
+    // Periodic top-of-book samples for research datasets
+    std::unique_ptr<L2Exporter> l2Exporter;
+    if (!l2Directory.empty()) {
+        l2Exporter.reset(new L2Exporter(l2Directory, l2Levels, l2EveryEvents, l2EveryMicros));
+        if (!l2Exporter->start()) {
+            return 1;
+        }
+        engine.set_book_update_callback([&l2Exporter](const std::string& symbol, const OrderBook& book) {
+            l2Exporter->on_book_update(symbol, book);
+        });
+        std::cout << "Exporting L2 snapshots to " << l2Directory << std::endl;
+    }
+    
+    // Flow toxicity runs on its own analytics thread; the matcher only queues executions
+    std::unique_ptr<FlowToxicityMonitor> toxicity;
+    if (vpinBucket > 0) {
+        toxicity.reset(new FlowToxicityMonitor(vpinBucket, vpinWindow, vpinThreshold));
+        toxicity->set_alert_callback([&server](const std::string& symbol, const FlowMetrics& metrics) {
+            std::cout << "Flow toxicity " << (metrics.toxic ? "HIGH" : "normal") << " for " << symbol
+                      << ": VPIN " << std::fixed << std::setprecision(3) << metrics.vpin << std::endl;
+            // Risk consumers widen or restore their limits on this message
+            server.broadcast_flow_alert(symbol, metrics);
+        });
+        server.set_metrics_callback([&toxicity](const std::string& symbol) {
+            if (symbol.empty()) {
+                return toxicity->get_all_metrics();
+            }
+            std::vector<std::pair<std::string, FlowMetrics>> result;
+            FlowMetrics metrics;
+            if (toxicity->get_metrics(symbol, metrics)) {
+                result.emplace_back(symbol, metrics);
+            }
+            return result;
+        });
+        toxicity->start();
+        std::cout << "Tracking VPIN with " << vpinBucket << "-share buckets over " << vpinWindow << " buckets" << std::endl;
+    }
+    
+    // One execution report per aggressive order, however many resting orders it hit
+    engine.set_execution_callback([&server, &dataInterface, &tape, &toxicity](const ExecutionReport& report) {
+        dataInterface.record_execution(report);
+        if (tape) {
+            tape->record(report);
+        }
+        if (toxicity) {
+            toxicity->record(report);
+        }
         
-        // Broadcast trade to all connected clients
-        server.broadcast_trade(trade);
+        std::cout << "Execution " << report.executionId << ": " << report.filledQuantity
+                  << " @ avg " << std::fixed << std::setprecision(2) << report.averagePrice
+                  << " across " << report.fills.size() << " fills, " << report.levelsTouched
+                  << " levels (worst " << report.worstPrice << ")" << std::endl;
+        
+        // Broadcast the whole sweep to all connected clients as one message
+        server.broadcast_execution(report);
     });
     
+    // Warm up on a shadow book before any client can connect; executions go
+    // through the broadcast path, which has no clients to send to yet
+    if (warmupMs > 0) {
+        WarmupOptions options;
+        options.durationMs = warmupMs;
+        WarmupReport warmup = run_warmup(engine, options, instruments.empty() ? nullptr : &instruments, hotWindow,
+            [&server](const ExecutionReport& report) {
+                server.broadcast_execution(report);
+            });
+        std::cout << "Warm-up: " << warmup.orders << " orders, " << warmup.executions << " executions in "
+                  << std::fixed << std::setprecision(2) << warmup.seconds << "s; median latency "
+                  << std::setprecision(0) << warmup.firstMedianNs << "ns -> " << warmup.finalMedianNs << "ns, "
+                  << (warmup.steady ? "steady state reached" : "steady state NOT reached") << std::endl;
+    }
+    
     // Start server
     std::cout << "\n--- Starting Server ---" << std::endl;
     if (!server.start(8080)) {
@@ -44,6 +328,7 @@ int main() {
     
     // Demo: Submit some sample orders
     std::cout << "\n--- Submitting Sample Orders ---" << std::endl;
+    std::unique_lock<std::mutex> demoLock(engineMutex);
     
     // Add some sell orders first
     std::string sellOrder1 = engine.submit_order(SELL, 100.50, 100, "AAPL", "CLIENT1");
@@ -56,12 +341,18 @@ int main() {
     std::string buyOrder3 = engine.submit_order(BUY, 100.30, 80, "AAPL", "CLIENT6");
     
     // Print current order book
-    engine.print_orderbook();
+    engine.print_orderbook(std::cout);
+    demoLock.unlock();
     
     // Start market simulation
     std::cout << "\n--- Starting Market Simulation ---" << std::endl;
     dataInterface.start_market_data_simulation("AAPL", 100.00, 20);
     
+    // Live ingestion of order files that other processes append to
+    if (!followFiles.empty() && !dataInterface.start_follow(followFiles, followOffsets)) {
+        std::cerr << "Failed to start follow mode" << std::endl;
+    }
+    
     std::cout << "\n=== Trading System Ready ===" << std::endl;
     std::cout << "Server running on port 8080" << std::endl;
     std::cout << "Frontend available at: http://localhost:8000" << std::endl;
@@ -74,23 +365,70 @@ int main() {
             std::this_thread::sleep_for(std::chrono::seconds(5));
             
             // Broadcast orderbook updates periodically
+            double bestBid;
+            double bestAsk;
+            {
+                std::lock_guard<std::mutex> lock(engineMutex);
+                bestBid = engine.get_best_bid();
+                bestAsk = engine.get_best_ask();
+            }
             server.broadcast_orderbook_update("AAPL", 
-                engine.get_best_bid(), 
-                engine.get_best_ask(), 
+                bestBid, 
+                bestAsk, 
                 100, // bid size placeholder
                 100  // ask size placeholder
             );
         }
     });
     
+    // On a quiet book, aged journal and tape blocks are handed over from here
+    // once their writer says they are due; the engine lock is only taken then
+    std::thread idleFlush([&]() {
+        while (running) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(10));
+            bool journalDue = journal && journal->flush_due();
+            bool tapeDue = tape && tape->flush_due();
+            if (journalDue || tapeDue) {
+                std::lock_guard<std::mutex> lock(engineMutex);
+                if (journalDue) journal->flush_aged();
+                if (tapeDue) tape->flush_aged();
+            }
+        }
+    });
+    
     // Wait for user to stop
     std::cin.get();
     running = false;
     
     // Cleanup
     marketSimulation.join();
+    idleFlush.join();
+    dataInterface.stop_follow();
     dataInterface.stop_simulation();
     server.stop();
+    if (kernelTimestamps) {
+        const GatewayLatency& latency = server.get_latency();
+        std::cout << "Wire-to-wire over " << latency.wireToWire.count() << " responses: p50 "
+                  << latency.wireToWire.percentile(0.50) << "ns, p99 " << latency.wireToWire.percentile(0.99)
+                  << "ns (socket queue p50 " << latency.socketQueue.percentile(0.50) << "ns, engine p50 "
+                  << latency.engine.percentile(0.50) << "ns, transmit p50 " << latency.transmit.percentile(0.50)
+                  << "ns)" << std::endl;
+    }
+    if (tape) {
+        tape->stop();
+    }
+    if (l2Exporter) {
+        l2Exporter->stop();
+    }
+    if (toxicity) {
+        toxicity->stop();
+    }
+    if (journal) {
+        journal->stop();
+    }
+    if (capture) {
+        capture->stop();
+    }
     
     std::cout << "\n=== System Shutdown Complete ===" << std::endl;
     return 0;
@@ -1,19 +1,19 @@
 #include "matchingEngine.hpp"
 #include <algorithm>
-#include <iostream>
+#include <limits>
 #include <sstream>
 
-MatchingEngine::MatchingEngine() : orderCounter(0) {
-  // Set up trade callback to forward to any external listeners
-  orderBook.set_trade_callback([this](const Trade &trade) {
-    // Could add additional processing here
-  });
-}
+MatchingEngine::MatchingEngine() : orderCounter(0), executionCounter(0) {}
 
 std::string MatchingEngine::submit_order(OrderType type, double price,
 int quantity,
                                          const std::string &symbol,
                                          const std::string &clientId) {
+  if (instruments) {
+    return submit_order(type, price, quantity, instruments->find(symbol),
+                        clientId);
+  }
+
   if (quantity <= 0 || price <= 0) {
     return ""; // Invalid order
   }
@@ -22,12 +22,93 @@ int quantity,
   auto order =
       std::make_shared<Order>(orderId, type, price, quantity, symbol, clientId);
 
+  if (onCommand) {
+    onCommand(COMMAND_NEW, *order);
+  }
+  match_order(order);
+  return orderId;
+}
+
+std::string MatchingEngine::submit_order(OrderType type, double price,
+                                         int quantity, uint32_t symbolId,
+                                         const std::string &clientId) {
+  if (!instruments || quantity <= 0 || price <= 0) {
+    return "";
+  }
+  if (instruments->validate(symbolId, InstrumentMaster::to_price_units(price),
+                            quantity) != INSTRUMENT_OK) {
+    return ""; // Off tick, off lot, outside band or unknown symbol
+  }
+
+  std::string orderId = generate_order_id();
+  auto order = std::make_shared<Order>(orderId, type, price, quantity,
+                                       instruments->get(symbolId).symbol,
+                                       clientId);
+  order->symbolId = symbolId;
+
+  if (onCommand) {
+    onCommand(COMMAND_NEW, *order);
+  }
+  match_order(order);
+  return orderId;
+}
+
+std::string MatchingEngine::submit_order(OrderType type, double price,
+                                         int quantity,
+                                         const std::string &symbol,
+                                         uint32_t symbolId,
+                                         const std::string &clientId) {
+  if (symbolId != InstrumentMaster::INVALID_SYMBOL_ID) {
+    return submit_order(type, price, quantity, symbolId, clientId);
+  }
+  return submit_order(type, price, quantity, symbol, clientId);
+}
+
+std::string MatchingEngine::submit_constrained_order(
+    OrderType type, double price, int quantity, int minQuantity, bool allOrNone,
+    const std::string &symbol, const std::string &clientId) {
+  if (quantity <= 0 || price <= 0 || minQuantity < 0 ||
+      minQuantity > quantity) {
+    return "";
+  }
+
+  uint32_t symbolId = UINT32_MAX;
+  if (instruments) {
+    symbolId = instruments->find(symbol);
+    if (instruments->validate(symbolId,
+                              InstrumentMaster::to_price_units(price),
+                              quantity) != INSTRUMENT_OK) {
+      return "";
+    }
+  }
+
+  std::string orderId = generate_order_id();
+  auto order =
+      std::make_shared<Order>(orderId, type, price, quantity, symbol, clientId);
+  order->symbolId = symbolId;
+  order->minQuantity = minQuantity;
+  order->allOrNone = allOrNone;
+
+  if (onCommand) {
+    onCommand(COMMAND_NEW, *order);
+  }
   match_order(order);
   return orderId;
 }
 
 bool MatchingEngine::cancel_order(const std::string &orderId) {
-  return orderBook.cancel_order(orderId);
+  auto order = orderBook.get_order(orderId);
+  if (!order || !orderBook.cancel_order(orderId)) {
+    return false;
+  }
+  if (onCommand) {
+    onCommand(COMMAND_CANCEL, *order);
+  }
+
+  if (onBookUpdate) {
+    onBookUpdate(order->symbol, orderBook);
+  }
+  return true;
 }
 
 bool MatchingEngine::modify_order(const std::string &orderId, double newPrice,
@@ -36,6 +117,12 @@ bool MatchingEngine::modify_order(const std::string &orderId, double newPrice,
   if (!order || order->status != PENDING) {
     return false;
   }
+  if (instruments &&
+      instruments->validate(order->symbolId,
+                            InstrumentMaster::to_price_units(newPrice),
+                            newQuantity) != INSTRUMENT_OK) {
+    return false;
+  }
 
   // Cancel existing order
   orderBook.cancel_order(orderId);
@@ -44,11 +131,56 @@ bool MatchingEngine::modify_order(const std::string &orderId, double newPrice,
   auto newOrder =
       std::make_shared<Order>(orderId, order->type, newPrice, newQuantity,
                               order->symbol, order->clientId);
+  newOrder->symbolId = order->symbolId;
+  newOrder->minQuantity = std::min(order->minQuantity, newQuantity);
+  newOrder->allOrNone = order->allOrNone;
+  if (onCommand) {
+    onCommand(COMMAND_MODIFY, *newOrder);
+  }
 
   match_order(newOrder);
   return true;
 }
 
+bool MatchingEngine::fill_resting_order(const std::string &orderId,
+                                        int quantity) {
+  auto order = orderBook.get_order(orderId);
+  if (!order || quantity <= 0 || order->getRemainingQuantity() < quantity) {
+    return false;
+  }
+
+  orderBook.fill_resting(order, quantity);
+
+  if (onBookUpdate) {
+    onBookUpdate(order->symbol, orderBook);
+  }
+  return true;
+}
+
+std::shared_ptr<Order>
+MatchingEngine::prepare_order(OrderType type, double price, int quantity,
+                              const std::string &symbol,
+                              const std::string &clientId) {
+  if (quantity <= 0 || price <= 0) {
+    return nullptr;
+  }
+
+  uint32_t symbolId = UINT32_MAX;
+  if (instruments) {
+    symbolId = instruments->find(symbol);
+    if (instruments->validate(symbolId,
+                              InstrumentMaster::to_price_units(price),
+                              quantity) != INSTRUMENT_OK) {
+      return nullptr;
+    }
+  }
+
+  auto order = std::make_shared<Order>(generate_order_id(), type, price,
+                                       quantity, symbol, clientId);
+  order->symbolId = symbolId;
+  return order;
+}
+
 std::shared_ptr<Order> MatchingEngine::get_order(const std::string &orderId) {
   return orderBook.get_order(orderId);
 }
@@ -69,18 +201,60 @@ MatchingEngine::get_ask_depth(int levels) const {
   return orderBook.get_ask_depth(levels);
 }
 
-void MatchingEngine::print_orderbook() const { orderBook.print_orderbook(); }
+void MatchingEngine::print_orderbook(std::ostream &out) const {
+  orderBook.print_orderbook(out);
+}
+
+void MatchingEngine::set_hot_window(double window) {
+  orderBook.set_hot_window(window);
+}
 
 void MatchingEngine::set_trade_callback(TradeCallback callback) {
   orderBook.set_trade_callback(callback);
 }
 
+void MatchingEngine::set_execution_callback(ExecutionCallback callback) {
+  onExecution = callback;
+}
+
+void MatchingEngine::set_book_update_callback(BookUpdateCallback callback) {
+  onBookUpdate = callback;
+}
+
+void MatchingEngine::set_level_callback(OrderBook::LevelCallback callback) {
+  orderBook.set_level_callback(callback);
+}
+
+void MatchingEngine::reserve(size_t orders) {
+  orderBook.orderIndex.reserve(orders, slotOrderIds);
+  executionReport.fills.reserve(64);
+}
+
+void MatchingEngine::prefetch(int step, OrderType side,
+                              std::string_view cancelId) const {
+  if (step == 0) {
+    __builtin_prefetch(this);
+    orderBook.prefetch(0, side);
+  } else if (cancelId.empty()) {
+    orderBook.prefetch(step, side);
+  } else {
+    orderBook.orderIndex.prefetch(cancelId, step - 1);
+  }
+}
+
 void MatchingEngine::process_orders_batch(
     const std::vector<std::shared_ptr<Order>> &orders) {
   for (const auto &order : orders) {
-    if (order && order->quantity > 0) {
-      match_order(order);
+    if (!order || order->quantity <= 0) {
+      continue;
+    }
+    if (order->orderId.empty()) {
+      order->orderId = generate_order_id();
     }
+    if (onCommand) {
+      onCommand(COMMAND_NEW, *order);
+    }
+    match_order(order);
   }
 }
 
@@ -93,6 +267,10 @@ size_t MatchingEngine::get_active_orders() const {
 }
 
 std::string MatchingEngine::generate_order_id() {
+  if (slotOrderIds) {
+    ++orderCounter;
+    return orderBook.orderIndex.allocate_id();
+  }
   std::ostringstream oss;
   oss << "O" << ++orderCounter;
   return oss.str();
@@ -102,34 +280,57 @@ void MatchingEngine::match_order(std::shared_ptr<Order> order) {
   if (!order || order->quantity <= 0)
     return;
 
+  // Constrained resting orders are only looked at when there are any; a
+  // constrained aggressor trades only if the plain book can satisfy it
+  bool takesConstrained = !order->isConstrained();
+  bool sweeps = takesConstrained ||
+                orderBook.fifo_quantity_through(
+                    order->type == BUY ? SELL : BUY, order->price,
+                    order->minExecutable()) >= order->minExecutable();
+
   if (order->type == BUY) {
+    takesConstrained = takesConstrained && !orderBook.constrainedSells.empty();
+    double cursor = -std::numeric_limits<double>::infinity();
+
     // Match buy order with sell orders (price-time priority)
-    while (order->getRemainingQuantity() > 0 && !orderBook.sellOrders.empty()) {
+    while (sweeps && order->getRemainingQuantity() > 0) {
       auto bestAskIt = orderBook.sellOrders.begin();
-      if (bestAskIt->first > order->price) {
-        break; // No more matching prices
-      }
-
-      auto &ordersAtPrice = bestAskIt->second;
-      if (ordersAtPrice.empty()) {
+      bool plain = bestAskIt != orderBook.sellOrders.end() &&
+                   bestAskIt->first <= order->price;
+      if (plain && bestAskIt->second.empty()) {
         orderBook.sellOrders.erase(bestAskIt);
         continue;
       }
+      if (plain && bestAskIt->second.front()->isFullyFilled()) {
+        // Filled but left in place: its ID was reused by a later order, so
+        // the index could not take it out
+        bestAskIt->second.erase(bestAskIt->second.begin());
+        continue;
+      }
+
+      // Constrained orders trade behind plain ones at the same price
+      std::shared_ptr<Order> sellOrder;
+      if (takesConstrained) {
+        sellOrder = orderBook.next_constrained(
+            SELL, cursor, plain ? bestAskIt->first : order->price, !plain,
+            order->getRemainingQuantity());
+      }
+      if (!sellOrder) {
+        if (!plain) {
+          break; // No more matching prices
+        }
+        sellOrder = bestAskIt->second.front();
+      }
 
-      auto &sellOrder = ordersAtPrice.front();
       int tradeQuantity = std::min(order->getRemainingQuantity(),
                                    sellOrder->getRemainingQuantity());
+      double tradePrice = sellOrder->price;
 
-      // Execute the trade
-      orderBook.execute_trade(order, sellOrder, tradeQuantity);
-
-      // Remove fully filled sell order
-      if (sellOrder->isFullyFilled()) {
-        ordersAtPrice.erase(ordersAtPrice.begin());
-        if (ordersAtPrice.empty()) {
-          orderBook.sellOrders.erase(bestAskIt);
-        }
-      }
+      // Execute the trade. A fully filled sell order is removed from the
+      // book there, which may also promote cold-tier levels, so the level
+      // iterator is not reused afterwards.
+      record_fill(sellOrder->orderId, tradePrice, tradeQuantity);
+      orderBook.execute_trade(order, sellOrder, tradeQuantity, tradePrice);
     }
 
     // Add remaining quantity to order book
@@ -138,33 +339,45 @@ void MatchingEngine::match_order(std::shared_ptr<Order> order) {
     }
 
   } else {
+    takesConstrained = takesConstrained && !orderBook.constrainedBuys.empty();
+    double cursor = std::numeric_limits<double>::infinity();
+
     // Match sell order with buy orders (price-time priority)
-    while (order->getRemainingQuantity() > 0 && !orderBook.buyOrders.empty()) {
+    while (sweeps && order->getRemainingQuantity() > 0) {
       auto bestBidIt = orderBook.buyOrders.begin();
-      if (bestBidIt->first < order->price) {
-        break; // No more matching prices
-      }
-
-      auto &ordersAtPrice = bestBidIt->second;
-      if (ordersAtPrice.empty()) {
+      bool plain = bestBidIt != orderBook.buyOrders.end() &&
+                   bestBidIt->first >= order->price;
+      if (plain && bestBidIt->second.empty()) {
         orderBook.buyOrders.erase(bestBidIt);
         continue;
       }
+      if (plain && bestBidIt->second.front()->isFullyFilled()) {
+        // Filled but left in place: its ID was reused by a later order, so
+        // the index could not take it out
+        bestBidIt->second.erase(bestBidIt->second.begin());
+        continue;
+      }
+
+      std::shared_ptr<Order> buyOrder;
+      if (takesConstrained) {
+        buyOrder = orderBook.next_constrained(
+            BUY, cursor, plain ? bestBidIt->first : order->price, !plain,
+            order->getRemainingQuantity());
+      }
+      if (!buyOrder) {
+        if (!plain) {
+          break; // No more matching prices
+        }
+        buyOrder = bestBidIt->second.front();
+      }
 
-      auto &buyOrder = ordersAtPrice.front();
       int tradeQuantity = std::min(order->getRemainingQuantity(),
                                    buyOrder->getRemainingQuantity());
+      double tradePrice = buyOrder->price;
 
-      // Execute the trade
-      orderBook.execute_trade(buyOrder, order, tradeQuantity);
-
-      // Remove fully filled buy order
-      if (buyOrder->isFullyFilled()) {
-        ordersAtPrice.erase(ordersAtPrice.begin());
-        if (ordersAtPrice.empty()) {
-          orderBook.buyOrders.erase(bestBidIt);
-        }
-      }
+      // Execute the trade (fully filled buy orders are removed there)
+      record_fill(buyOrder->orderId, tradePrice, tradeQuantity);
+      orderBook.execute_trade(buyOrder, order, tradeQuantity, tradePrice);
     }
 
     // Add remaining quantity to order book
@@ -172,4 +385,57 @@ void MatchingEngine::match_order(std::shared_ptr<Order> order) {
       orderBook.add_order(order);
     }
   }
+
+  // A slot ID is only held while its order rests
+  if (order->getRemainingQuantity() == 0) {
+    orderBook.orderIndex.release_id(order->orderId);
+  }
+
+  publish_execution(*order);
+
+  if (onBookUpdate) {
+    onBookUpdate(order->symbol, orderBook);
+  }
+}
+
+void MatchingEngine::record_fill(const std::string &passiveOrderId,
+                                 double price, int quantity) {
+  if (!onExecution)
+    return;
+
+  auto &fills = executionReport.fills;
+  if (fills.empty() || fills.back().price != price) {
+    executionReport.levelsTouched++;
+  }
+  fills.push_back({passiveOrderId, price, quantity});
+}
+
+void MatchingEngine::publish_execution(const Order &order) {
+  ExecutionReport &report = executionReport;
+  if (report.fills.empty())
+    return;
+
+  double notional = 0.0;
+  int filled = 0;
+  for (const auto &fill : report.fills) {
+    notional += fill.price * fill.quantity;
+    filled += fill.quantity;
+  }
+
+  report.executionId = "E" + std::to_string(++executionCounter);
+  report.orderId = order.orderId;
+  report.symbol = order.symbol;
+  report.clientId = order.clientId;
+  report.side = order.type;
+  report.filledQuantity = filled;
+  report.remainingQuantity = order.getRemainingQuantity();
+  report.averagePrice = notional / filled;
+  report.worstPrice = report.fills.back().price; // sweeps walk best to worst
+  report.timestamp = std::chrono::system_clock::now();
+
+  onExecution(report);
+
+  // Keep the fill buffer's capacity for the next sweep
+  report.fills.clear();
+  report.levelsTouched = 0;
 }
@@ -4,13 +4,21 @@
 
 #include "order.hpp"
 #include "orderBook.hpp"
+#include "instrument.hpp"
 #include <string>
+#include <string_view>
 #include <vector>
 #include <functional>
+#include <ostream>
+
+enum EngineCommand : uint8_t { COMMAND_NEW, COMMAND_CANCEL, COMMAND_MODIFY };
 
 class MatchingEngine {
 public:
     using TradeCallback = std::function<void(const Trade&)>;
+    using ExecutionCallback = std::function<void(const ExecutionReport&)>;
+    using BookUpdateCallback = std::function<void(const std::string& symbol, const OrderBook&)>;
+    using CommandCallback = std::function<void(EngineCommand command, const Order& order)>;
     
     MatchingEngine();
     
@@ -18,6 +26,21 @@ public:
     std::string submit_order(OrderType type, double price, int quantity, 
     const std::string& symbol = "DEFAULT", 
     const std::string& clientId = "DEFAULT");
+    std::string submit_order(OrderType type, double price, int quantity,
+    uint32_t symbolId, const std::string& clientId);
+    // For callers that resolved the symbol once with symbol_id(): by ID when
+    // there is one, by name otherwise (no instrument master, unknown symbol)
+    std::string submit_order(OrderType type, double price, int quantity,
+    const std::string& symbol, uint32_t symbolId, const std::string& clientId);
+    
+    // All-or-none, or minimum-quantity when minQuantity > 1. While resting these
+    // only trade against a single aggressor big enough for them, after the plain
+    // orders at the same price. As aggressors they take plain liquidity only, and
+    // rest without trading if there is not enough of it.
+    std::string submit_constrained_order(OrderType type, double price, int quantity,
+    int minQuantity, bool allOrNone,
+    const std::string& symbol = "DEFAULT",
+    const std::string& clientId = "DEFAULT");
     bool cancel_order(const std::string& orderId);
     bool modify_order(const std::string& orderId, double newPrice, int newQuantity);
     std::shared_ptr<Order> get_order(const std::string& orderId);
@@ -30,10 +53,64 @@ public:
     std::vector<std::pair<double, int>> get_ask_depth(int levels = 5) const;
     
     // Order book operations
-    void print_orderbook() const;
+    void print_orderbook(std::ostream& out) const;
     void set_trade_callback(TradeCallback callback);
     
-    // Batch operations for real-time data
+    // One report per aggressive order that traded, covering every fill of its sweep.
+    // The report is reused between calls; copy it if it must outlive the callback.
+    void set_execution_callback(ExecutionCallback callback);
+    
+    // Called on the matching thread after every order, modify or cancel that reached the book
+    void set_book_update_callback(BookUpdateCallback callback);
+    
+    // Every command the engine accepted, whoever sent it, before it matches:
+    // new orders with their assigned ID, cancels, and modifies with the order's
+    // new price and quantity. Called on the matching thread, for journaling.
+    void set_command_callback(CommandCallback callback) { onCommand = callback; }
+    
+    // Incremental depth: called whenever the resting quantity at a price changes
+    void set_level_callback(OrderBook::LevelCallback callback);
+    
+    // Reference data. When set, orders for unknown symbols or with prices/quantities
+    // off tick, off lot or outside the price band are rejected.
+    void set_instrument_master(const InstrumentMaster* master) { instruments = master; }
+    uint32_t symbol_id(const std::string& symbol) const {
+        return instruments ? instruments->find(symbol) : InstrumentMaster::INVALID_SYMBOL_ID;
+    }
+    
+    // Keep only levels within window of the touch in the matching structure;
+    // far levels sit in a compact cold tier until the market comes closer
+    void set_hot_window(double window);
+    size_t get_cold_orders() const { return orderBook.get_cold_order_count(); }
+    
+    // For matchers spanning several books (implied spreads): read access to the
+    // book, filling a resting order against liquidity held elsewhere, and an
+    // incoming order that may be filled elsewhere (prepare_order, nullptr if
+    // invalid) before it is matched here with whatever remains (submit_prepared)
+    const OrderBook& get_order_book() const { return orderBook; }
+    bool fill_resting_order(const std::string& orderId, int quantity);
+    std::shared_ptr<Order> prepare_order(OrderType type, double price, int quantity,
+                                         const std::string& symbol, const std::string& clientId = "DEFAULT");
+    void submit_prepared(const std::shared_ptr<Order>& order) { match_order(order); }
+    
+    // Presize the order lookup and the execution report buffer so the first orders
+    // after start-up do not pay for rehashing and growth
+    void reserve(size_t orders);
+    
+    // Assign slot/generation order IDs ("S<n>", see OrderIndex) instead of "O<n>",
+    // so cancels and modifies find their order without hashing. Orders already
+    // resting keep their IDs; can be switched at any time.
+    void set_slot_order_ids(bool enabled) { slotOrderIds = enabled; }
+    bool get_slot_order_ids() const { return slotOrderIds; }
+    
+    // Batched execution: one step of loading what a new order on side (or, when
+    // cancelId is given, that cancel) will touch. Run steps 0..PREFETCH_STEPS-1
+    // over a window of commands, a step at a time, before executing any of them.
+    static constexpr int PREFETCH_STEPS = OrderBook::PREFETCH_STEPS;
+    void prefetch(int step, OrderType side, std::string_view cancelId = std::string_view()) const;
+    
+    // Batch operations for real-time data. Orders with an empty ID are given
+    // one by the engine.
     void process_orders_batch(const std::vector<std::shared_ptr<Order>>& orders);
     
     // Statistics
@@ -42,9 +119,19 @@ public:
 
 private:
     OrderBook orderBook;
+    const InstrumentMaster* instruments = nullptr;
     std::string generate_order_id();
     void match_order(std::shared_ptr<Order> order);
+    void record_fill(const std::string& passiveOrderId, double price, int quantity);
+    void publish_execution(const Order& order);
     int orderCounter;
+    bool slotOrderIds = false;
+    
+    ExecutionCallback onExecution;
+    BookUpdateCallback onBookUpdate;
+    CommandCallback onCommand;
+    ExecutionReport executionReport;
+    uint64_t executionCounter;
 };
 
 #endif
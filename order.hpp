@@ -4,7 +4,9 @@
 
 #include <string>
 #include <chrono>
+#include <cstdint>
 #include <memory>
+#include <vector>
 
 enum OrderType { BUY, SELL };
 enum OrderStatus { PENDING, PARTIALLY_FILLED, FILLED, CANCELLED, REJECTED };
@@ -20,10 +22,13 @@ public:
     std::chrono::system_clock::time_point timestamp;
     std::string symbol;
     std::string clientId;
+    uint32_t symbolId;      // InstrumentMaster ID, UINT32_MAX when not validated
+    int minQuantity = 0;    // smallest fill this order accepts; 0 or 1 for none
+    bool allOrNone = false; // only fills its whole remaining quantity at once
 
     Order(const std::string& id, OrderType t, double p, int q, const std::string& sym = "DEFAULT", const std::string& client = "DEFAULT")
         : orderId(id), type(t), price(p), quantity(q), filledQuantity(0), status(PENDING), 
-          timestamp(std::chrono::system_clock::now()), symbol(sym), clientId(client) {}
+          timestamp(std::chrono::system_clock::now()), symbol(sym), clientId(client), symbolId(UINT32_MAX) {}
 
     bool isFullyFilled() const { return filledQuantity >= quantity; }
     int getRemainingQuantity() const { return quantity - filledQuantity; }
@@ -33,6 +38,14 @@ public:
         else if (filledQuantity > 0) status = PARTIALLY_FILLED;
     }
     void cancel() { status = CANCELLED; }
+    
+    bool isConstrained() const { return allOrNone || minQuantity > 1; }
+    // Smallest quantity that may trade against this order right now
+    int minExecutable() const {
+        int remaining = getRemainingQuantity();
+        if (allOrNone || minQuantity > remaining) return remaining;
+        return minQuantity;
+    }
 };
 
 struct Trade {
@@ -50,4 +63,28 @@ struct Trade {
           timestamp(std::chrono::system_clock::now()) {}
 };
 
+// One resting order hit by an aggressor, as carried in an ExecutionReport
+struct Fill {
+    std::string passiveOrderId;
+    double price;
+    int quantity;
+};
+
+// Aggressor-side summary of one sweep through the book, with the passive fills
+// it produced in a single contiguous batch
+struct ExecutionReport {
+    std::string executionId;
+    std::string orderId;
+    std::string symbol;
+    std::string clientId;
+    OrderType side = BUY;
+    int filledQuantity = 0;
+    int remainingQuantity = 0;
+    double averagePrice = 0.0;
+    double worstPrice = 0.0;
+    int levelsTouched = 0;
+    std::vector<Fill> fills;
+    std::chrono::system_clock::time_point timestamp;
+};
+
 #endif
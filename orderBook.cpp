@@ -1,55 +1,88 @@
 // orderBook.cpp
 #include "orderBook.hpp"
-#include <iostream>
+#include <algorithm>
 #include <iomanip>
 #include <sstream>
 #include <random>
+#include <limits>
+
+namespace {
+
+// Heap comparator for the cold tier: best price on top, then oldest
+struct ColdHeapOrder {
+    OrderType side;
+    bool operator()(const OrderBook::ColdOrder& a, const OrderBook::ColdOrder& b) const {
+        if (a.price != b.price) return (side == BUY) ? a.price < b.price : a.price > b.price;
+        return a.sequence > b.sequence;
+    }
+};
+
+// Compacting a cold heap costs a full pass, so only bother once it is mostly tombstones
+constexpr size_t COLD_COMPACT_MIN_DEAD = 1024;
+
+// Takes order out of its hot level; false if it is not in one (a cold order)
+template <typename Levels>
+bool erase_from_level(Levels& levels, const std::shared_ptr<Order>& order) {
+    auto priceIt = levels.find(order->price);
+    if (priceIt == levels.end()) return false;
+    
+    auto& orders = priceIt->second;
+    auto it = std::find(orders.begin(), orders.end(), order);
+    if (it == orders.end()) return false;
+    
+    orders.erase(it);
+    if (orders.empty()) {
+        levels.erase(priceIt);
+    }
+    return true;
+}
+
+} // namespace
 
 void OrderBook::add_order(std::shared_ptr<Order> order) {
     if (!order || order->quantity <= 0) return;
     
     // Store in order map for quick lookup
-    orderMap[order->orderId] = order;
+    orderIndex.insert(order);
     
-    if (order->type == BUY) {
+    if (order->isConstrained()) {
+        add_constrained_order(order);
+    } else if (is_cold(*order)) {
+        add_cold_order(order);
+    } else if (order->type == BUY) {
         buyOrders[order->price].push_back(order);
     } else {
         sellOrders[order->price].push_back(order);
     }
     
+    if (onLevelChange) {
+        onLevelChange(order->type, order->price, order->getRemainingQuantity());
+    }
     update_market_data();
 }
 
 bool OrderBook::remove_order(const std::string& orderId) {
-    auto it = orderMap.find(orderId);
-    if (it == orderMap.end()) return false;
+    const std::shared_ptr<Order>* found = orderIndex.find(orderId);
+    if (!found) return false;
     
-    auto order = it->second;
-    orderMap.erase(it);
+    auto order = *found;
+    orderIndex.erase(orderId);
     
-    if (order->type == BUY) {
-        auto priceIt = buyOrders.find(order->price);
-        if (priceIt != buyOrders.end()) {
-            auto& orders = priceIt->second;
-            orders.erase(std::remove_if(orders.begin(), orders.end(),
-                [&orderId](const std::shared_ptr<Order>& o) { return o->orderId == orderId; }),
-                orders.end());
-            
-            if (orders.empty()) {
-                buyOrders.erase(priceIt);
-            }
+    // Fully filled orders already reported their quantity through their fills
+    if (onLevelChange && order->getRemainingQuantity() > 0) {
+        onLevelChange(order->type, order->price, -order->getRemainingQuantity());
+    }
+    
+    // Cold orders are left in the heap as tombstones
+    if (order->isConstrained()) {
+        remove_constrained_order(order);
+    } else if (order->type == BUY) {
+        if (!erase_from_level(buyOrders, order)) {
+            ++deadColdBuys;
         }
     } else {
-        auto priceIt = sellOrders.find(order->price);
-        if (priceIt != sellOrders.end()) {
-            auto& orders = priceIt->second;
-            orders.erase(std::remove_if(orders.begin(), orders.end(),
-                [&orderId](const std::shared_ptr<Order>& o) { return o->orderId == orderId; }),
-                orders.end());
-            
-            if (orders.empty()) {
-                sellOrders.erase(priceIt);
-            }
+        if (!erase_from_level(sellOrders, order)) {
+            ++deadColdSells;
         }
     }
     
@@ -57,20 +90,260 @@ bool OrderBook::remove_order(const std::string& orderId) {
     return true;
 }
 
+// Only if the index still maps the order's ID to this very order: the other
+// side of a trade is not in the book, and an order whose ID was reused by a
+// later order is left for the sweep, which drops filled orders off the front
+void OrderBook::remove_filled(const std::shared_ptr<Order>& order) {
+    const std::shared_ptr<Order>* found = orderIndex.find(order->orderId);
+    if (found && *found == order) {
+        remove_order(order->orderId);
+    }
+}
+
 bool OrderBook::cancel_order(const std::string& orderId) {
-    auto it = orderMap.find(orderId);
-    if (it == orderMap.end()) return false;
+    const std::shared_ptr<Order>* found = orderIndex.find(orderId);
+    if (!found) return false;
     
-    it->second->cancel();
+    (*found)->cancel();
     return remove_order(orderId);
 }
 
 std::shared_ptr<Order> OrderBook::get_order(const std::string& orderId) {
-    auto it = orderMap.find(orderId);
-    return (it != orderMap.end()) ? it->second : nullptr;
+    const std::shared_ptr<Order>* found = orderIndex.find(orderId);
+    return found ? *found : nullptr;
+}
+
+void OrderBook::prefetch(int step, OrderType side) const {
+    if (step == 0) {
+        __builtin_prefetch(this);
+        __builtin_prefetch(&sellOrders);
+        __builtin_prefetch(&orderIndex);
+        __builtin_prefetch(&bestBid);
+        return;
+    }
+    // Matching reads the opposite side's touch
+    if (side == BUY) {
+        prefetch_touch(sellOrders, step);
+    } else {
+        prefetch_touch(buyOrders, step);
+    }
+}
+
+template <typename Levels>
+void OrderBook::prefetch_touch(const Levels& levels, int step) {
+    if (levels.empty()) return;
+    const auto& best = *levels.begin();
+    if (step == 1) {
+        __builtin_prefetch(&best);
+    } else if (step == 2) {
+        __builtin_prefetch(best.second.data());
+    } else if (step == 3 && !best.second.empty()) {
+        __builtin_prefetch(best.second.front().get());
+    }
+}
+
+void OrderBook::set_hot_window(double window) {
+    if (window <= 0) {
+        // Bring every cold order back before switching tiering off
+        hotWindow = std::numeric_limits<double>::infinity();
+        rebalance_tiers();
+        hotWindow = 0.0;
+    } else {
+        hotWindow = window;
+    }
+    update_market_data();
+}
+
+void OrderBook::add_constrained_order(const std::shared_ptr<Order>& order) {
+    int key = order->minExecutable();
+    if (order->type == BUY) {
+        constrainedBuys[order->price].emplace(key, order);
+        constrainedBuyKeys.insert(key);
+    } else {
+        constrainedSells[order->price].emplace(key, order);
+        constrainedSellKeys.insert(key);
+    }
+}
+
+bool OrderBook::remove_constrained_order(const std::shared_ptr<Order>& order) {
+    auto removeFrom = [&order](auto& levels, std::multiset<int>& keys) {
+        auto levelIt = levels.find(order->price);
+        if (levelIt == levels.end()) return false;
+        
+        // The key may be stale for an order that was just filled, so match on the order
+        auto& level = levelIt->second;
+        for (auto it = level.begin(); it != level.end(); ++it) {
+            if (it->second == order) {
+                keys.erase(keys.find(it->first));
+                level.erase(it);
+                if (level.empty()) levels.erase(levelIt);
+                return true;
+            }
+        }
+        return false;
+    };
+    return (order->type == BUY) ? removeFrom(constrainedBuys, constrainedBuyKeys)
+                                : removeFrom(constrainedSells, constrainedSellKeys);
+}
+
+void OrderBook::rekey_constrained_order(const std::shared_ptr<Order>& order, int oldKey) {
+    int newKey = order->minExecutable();
+    if (newKey == oldKey) return;
+    
+    auto rekey = [&order, oldKey, newKey](auto& levels, std::multiset<int>& keys) {
+        auto levelIt = levels.find(order->price);
+        if (levelIt == levels.end()) return;
+        
+        auto& level = levelIt->second;
+        auto range = level.equal_range(oldKey);
+        for (auto it = range.first; it != range.second; ++it) {
+            if (it->second == order) {
+                level.erase(it);
+                level.emplace(newKey, order);
+                keys.erase(keys.find(oldKey));
+                keys.insert(newKey);
+                return;
+            }
+        }
+    };
+    if (order->type == BUY) {
+        rekey(constrainedBuys, constrainedBuyKeys);
+    } else {
+        rekey(constrainedSells, constrainedSellKeys);
+    }
+}
+
+namespace {
+
+template <typename Levels>
+std::shared_ptr<Order> find_constrained(const Levels& levels, double& cursor, double bound, bool inclusive, int available) {
+    auto before = levels.key_comp();
+    auto it = levels.lower_bound(cursor);
+    for (; it != levels.end(); ++it) {
+        if (inclusive ? before(bound, it->first) : !before(it->first, bound)) break;
+        
+        // Smallest minimum first: if that one cannot trade, nothing at this price can
+        if (it->second.begin()->first <= available) {
+            cursor = it->first;
+            return it->second.begin()->second;
+        }
+    }
+    
+    if (it != levels.end()) {
+        cursor = it->first;
+    } else {
+        cursor = before(0.0, 1.0) ? std::numeric_limits<double>::infinity()
+                                  : -std::numeric_limits<double>::infinity();
+    }
+    return nullptr;
+}
+
+template <typename Levels>
+int fifo_quantity(const Levels& levels, double limit, int needed) {
+    auto before = levels.key_comp();
+    int quantity = 0;
+    for (auto it = levels.begin(); it != levels.end() && quantity < needed && !before(limit, it->first); ++it) {
+        for (const auto& order : it->second) {
+            quantity += order->getRemainingQuantity();
+        }
+    }
+    return std::min(quantity, needed);
+}
+
+} // namespace
+
+std::shared_ptr<Order> OrderBook::next_constrained(OrderType side, double& cursor, double bound, bool inclusive,
+                                                   int available) const {
+    const std::multiset<int>& keys = (side == BUY) ? constrainedBuyKeys : constrainedSellKeys;
+    if (keys.empty() || *keys.begin() > available) return nullptr;
+    
+    return (side == BUY) ? find_constrained(constrainedBuys, cursor, bound, inclusive, available)
+                         : find_constrained(constrainedSells, cursor, bound, inclusive, available);
+}
+
+int OrderBook::fifo_quantity_through(OrderType side, double limit, int needed) const {
+    return (side == BUY) ? fifo_quantity(buyOrders, limit, needed) : fifo_quantity(sellOrders, limit, needed);
+}
+
+bool OrderBook::is_cold(const Order& order) const {
+    if (hotWindow <= 0) return false;
+    
+    // With an empty hot side the cold side is empty too, so the order sets the touch.
+    // Orders at or inside the worst hot level stay hot to keep the tier contiguous.
+    if (order.type == BUY) {
+        if (buyOrders.empty() || order.price >= buyOrders.rbegin()->first) return false;
+        return buyOrders.begin()->first - order.price > hotWindow;
+    }
+    if (sellOrders.empty() || order.price <= sellOrders.rbegin()->first) return false;
+    return order.price - sellOrders.begin()->first > hotWindow;
+}
+
+void OrderBook::add_cold_order(std::shared_ptr<Order> order) {
+    auto& cold = (order->type == BUY) ? coldBuys : coldSells;
+    OrderType side = order->type;
+    cold.push_back({order->price, ++coldSequence, std::move(order)});
+    std::push_heap(cold.begin(), cold.end(), ColdHeapOrder{side});
+}
+
+void OrderBook::rebalance_tiers() {
+    if (hotWindow <= 0) return;
+    rebalance_side(buyOrders, coldBuys, deadColdBuys, BUY);
+    rebalance_side(sellOrders, coldSells, deadColdSells, SELL);
+}
+
+template <typename Levels>
+void OrderBook::rebalance_side(Levels& levels, std::vector<ColdOrder>& cold, size_t& dead, OrderType side) {
+    ColdHeapOrder heapOrder{side};
+    auto distance = [side](double touch, double price) {
+        return (side == BUY) ? touch - price : price - touch;
+    };
+    auto isLive = [this](const ColdOrder& entry) {
+        const std::shared_ptr<Order>* found = orderIndex.find(entry.order->orderId);
+        return found && *found == entry.order;
+    };
+    
+    if (dead > COLD_COMPACT_MIN_DEAD && dead * 2 > cold.size()) {
+        cold.erase(std::remove_if(cold.begin(), cold.end(),
+            [&isLive](const ColdOrder& entry) { return !isLive(entry); }), cold.end());
+        std::make_heap(cold.begin(), cold.end(), heapOrder);
+        dead = 0;
+    }
+    
+    // Promote cold orders the touch has come within reach of, and any priced at
+    // or inside the worst hot level, so the hot tier never skips cold liquidity
+    while (!cold.empty()) {
+        if (!levels.empty() && distance(levels.begin()->first, cold.front().price) > hotWindow &&
+            distance(levels.rbegin()->first, cold.front().price) > 0) {
+            break;
+        }
+        
+        std::pop_heap(cold.begin(), cold.end(), heapOrder);
+        ColdOrder entry = std::move(cold.back());
+        cold.pop_back();
+        
+        if (isLive(entry)) {
+            levels[entry.price].push_back(std::move(entry.order));
+        } else {
+            --dead;
+        }
+    }
+    
+    // Demote levels the market has moved away from
+    while (levels.size() > 1) {
+        auto worst = std::prev(levels.end());
+        if (distance(levels.begin()->first, worst->first) <= 2 * hotWindow) break;
+        
+        for (auto& order : worst->second) {
+            cold.push_back({worst->first, ++coldSequence, std::move(order)});
+            std::push_heap(cold.begin(), cold.end(), heapOrder);
+        }
+        levels.erase(worst);
+    }
 }
 
 void OrderBook::update_market_data() {
+    rebalance_tiers();
+    
     bestBid = 0.0;
     bestAsk = 0.0;
     bidSize = 0;
@@ -131,32 +404,64 @@ std::vector<std::pair<double, int>> OrderBook::get_ask_depth(int levels) const {
     return depth;
 }
 
-void OrderBook::print_orderbook() const {
-    std::cout << "\n=== ORDER BOOK ===" << std::endl;
-    std::cout << "Best Bid: " << std::fixed << std::setprecision(2) << bestBid 
-              << " (" << bidSize << ")" << std::endl;
-    std::cout << "Best Ask: " << std::fixed << std::setprecision(2) << bestAsk 
-              << " (" << askSize << ")" << std::endl;
-    std::cout << "Spread: " << std::fixed << std::setprecision(2) << get_spread() << std::endl;
+namespace {
+
+template <typename Levels>
+int fill_depth_levels(const Levels& sideLevels, DepthLevel* out, int levels) {
+    int count = 0;
+    for (auto it = sideLevels.begin(); it != sideLevels.end() && count < levels; ++it, ++count) {
+        int totalSize = 0;
+        for (const auto& order : it->second) {
+            totalSize += order->getRemainingQuantity();
+        }
+        out[count] = {it->first, totalSize, static_cast<int>(it->second.size())};
+    }
+    return count;
+}
+
+} // namespace
+
+int OrderBook::get_bid_levels(DepthLevel* out, int levels) const {
+    return fill_depth_levels(buyOrders, out, levels);
+}
+
+int OrderBook::get_ask_levels(DepthLevel* out, int levels) const {
+    return fill_depth_levels(sellOrders, out, levels);
+}
+
+void OrderBook::print_orderbook(std::ostream& out) const {
+    out << "\n=== ORDER BOOK ===" << std::endl;
+    out << "Best Bid: " << std::fixed << std::setprecision(2) << bestBid 
+        << " (" << bidSize << ")" << std::endl;
+    out << "Best Ask: " << std::fixed << std::setprecision(2) << bestAsk 
+        << " (" << askSize << ")" << std::endl;
+    out << "Spread: " << std::fixed << std::setprecision(2) << get_spread() << std::endl;
     
-    std::cout << "\n--- ASK SIDE ---" << std::endl;
+    out << "\n--- ASK SIDE ---" << std::endl;
     auto askDepth = get_ask_depth(5);
     for (auto it = askDepth.rbegin(); it != askDepth.rend(); ++it) {
-        std::cout << std::fixed << std::setprecision(2) << it->first << " | " << it->second << std::endl;
+        out << std::fixed << std::setprecision(2) << it->first << " | " << it->second << std::endl;
     }
     
-    std::cout << "--- BID SIDE ---" << std::endl;
+    out << "--- BID SIDE ---" << std::endl;
     auto bidDepth = get_bid_depth(5);
     for (const auto& level : bidDepth) {
-        std::cout << std::fixed << std::setprecision(2) << level.first << " | " << level.second << std::endl;
+        out << std::fixed << std::setprecision(2) << level.first << " | " << level.second << std::endl;
     }
-    std::cout << "================\n" << std::endl;
+    out << "================\n" << std::endl;
 }
 
-void OrderBook::execute_trade(std::shared_ptr<Order> buyOrder, std::shared_ptr<Order> sellOrder, int quantity) {
-    // Create trade record
-    Trade trade(generate_trade_id(), buyOrder->orderId, sellOrder->orderId, 
-                buyOrder->symbol, sellOrder->price, quantity);
+void OrderBook::execute_trade(std::shared_ptr<Order> buyOrder, std::shared_ptr<Order> sellOrder, int quantity, double price) {
+    // Only the resting side is in the book yet
+    const std::shared_ptr<Order>* resting = nullptr;
+    if (onLevelChange || buyOrder->isConstrained() || sellOrder->isConstrained()) {
+        const std::shared_ptr<Order>* found = orderIndex.find(buyOrder->orderId);
+        resting = (found && *found == buyOrder) ? &buyOrder : &sellOrder;
+    }
+    if (onLevelChange) {
+        onLevelChange((*resting)->type, (*resting)->price, -quantity);
+    }
+    int restingKey = (resting && (*resting)->isConstrained()) ? (*resting)->minExecutable() : 0;
     
     // Update order quantities
     buyOrder->fill(quantity);
@@ -164,19 +469,37 @@ void OrderBook::execute_trade(std::shared_ptr<Order> buyOrder, std::shared_ptr<O
     
     // Remove fully filled orders
     if (buyOrder->isFullyFilled()) {
-        remove_order(buyOrder->orderId);
+        remove_filled(buyOrder);
     }
     if (sellOrder->isFullyFilled()) {
-        remove_order(sellOrder->orderId);
+        remove_filled(sellOrder);
     }
     
-    // Call trade callback if set
+    // A partly filled minimum-quantity order may now accept a smaller last fill
+    if (restingKey > 0 && !(*resting)->isFullyFilled()) {
+        rekey_constrained_order(*resting, restingKey);
+    }
+    
+    // Per-fill trade records are only built for listeners that want them
     if (onTrade) {
-        onTrade(trade);
+        onTrade(Trade(generate_trade_id(), buyOrder->orderId, sellOrder->orderId,
+                      buyOrder->symbol, price, quantity));
+    }
+}
+
+void OrderBook::fill_resting(const std::shared_ptr<Order>& order, int quantity) {
+    if (onLevelChange) {
+        onLevelChange(order->type, order->price, -quantity);
     }
     
-    std::cout << "TRADE: " << quantity << " @ " << std::fixed << std::setprecision(2) 
-              << trade.price << " (Trade ID: " << trade.tradeId << ")" << std::endl;
+    int restingKey = order->isConstrained() ? order->minExecutable() : 0;
+    order->fill(quantity);
+    if (order->isFullyFilled()) {
+        remove_filled(order);
+    } else {
+        if (restingKey > 0) rekey_constrained_order(order, restingKey);
+        update_market_data();
+    }
 }
 
 std::string OrderBook::generate_trade_id() {
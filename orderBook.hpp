@@ -3,11 +3,21 @@
 #define ORDERBOOK_HPP
 
 #include <map>
+#include <set>
 #include <unordered_map>
 #include <vector>
 #include <memory>
 #include <functional>
+#include <ostream>
 #include "order.hpp"
+#include "orderIndex.hpp"
+
+// Aggregate of one price level
+struct DepthLevel {
+    double price;
+    int quantity;
+    int orders;
+};
 
 class OrderBook {
 public:
@@ -15,8 +25,26 @@ public:
     std::map<double, std::vector<std::shared_ptr<Order>>, std::greater<double>> buyOrders;  // Descending price
     std::map<double, std::vector<std::shared_ptr<Order>>> sellOrders;  // Ascending price
     
-    // Order ID -> Order mapping for quick lookup
-    std::unordered_map<std::string, std::shared_ptr<Order>> orderMap;
+    // Order ID -> Order mapping for quick lookup; slot IDs skip hashing
+    OrderIndex orderIndex;
+    
+    // Cold tier: orders further than hotWindow from the touch. Kept out of the
+    // level maps in a flat heap per side (best price, then oldest, on top) and
+    // moved into the maps as the market approaches them.
+    struct ColdOrder {
+        double price;
+        uint64_t sequence;
+        std::shared_ptr<Order> order;
+    };
+    std::vector<ColdOrder> coldBuys;
+    std::vector<ColdOrder> coldSells;
+    
+    // All-or-none and minimum-quantity orders rest beside the FIFO levels, per price
+    // indexed by the smallest quantity each will execute (ties in time order), so a
+    // sweep goes straight to an order it can fill. Not part of the displayed depth.
+    using ConstrainedLevel = std::multimap<int, std::shared_ptr<Order>>;
+    std::map<double, ConstrainedLevel, std::greater<double>> constrainedBuys;
+    std::map<double, ConstrainedLevel> constrainedSells;
     
     // Market data
     double bestBid = 0.0;
@@ -27,6 +55,11 @@ public:
     // Trade callback function type
     using TradeCallback = std::function<void(const Trade&)>;
     TradeCallback onTrade;
+    
+    // Resting quantity at (side, price) changed by delta. Fired for both tiers,
+    // so summing the deltas reproduces the book's full resting depth.
+    using LevelCallback = std::function<void(OrderType side, double price, int delta)>;
+    LevelCallback onLevelChange;
 
     OrderBook() = default;
     
@@ -42,21 +75,77 @@ public:
     int get_bid_size() const { return bidSize; }
     int get_ask_size() const { return askSize; }
     
-    // Get top N levels of market depth
+    // Tiering: levels more than window away from the touch go to the cold tier.
+    // Levels drift back out once they are twice the window away. The hot tier is
+    // always a contiguous run of levels from the touch: every cold order is priced
+    // worse than the worst hot level. 0 disables tiering.
+    void set_hot_window(double window);
+    double get_hot_window() const { return hotWindow; }
+    size_t get_cold_order_count() const { return coldBuys.size() + coldSells.size() - deadColdBuys - deadColdSells; }
+    
+    // First constrained order on side that can trade against available quantity,
+    // priced no worse than bound (strictly better unless inclusive). Scans from
+    // cursor and moves it past levels with nothing eligible; start it at -inf for
+    // sells and +inf for buys. Eligibility only shrinks as available drops, so a
+    // sweep never looks at a skipped level again.
+    std::shared_ptr<Order> next_constrained(OrderType side, double& cursor, double bound, bool inclusive, int available) const;
+    
+    // FIFO quantity on side priced no worse than limit, counted up to needed
+    int fifo_quantity_through(OrderType side, double limit, int needed) const;
+    
+    // Get top N levels of market depth (hot tier only, so at least the levels
+    // within the hot window)
     std::vector<std::pair<double, int>> get_bid_depth(int levels = 5) const;
     std::vector<std::pair<double, int>> get_ask_depth(int levels = 5) const;
     
+    // Top N levels with order counts, written to a caller buffer; returns levels filled
+    int get_bid_levels(DepthLevel* out, int levels) const;
+    int get_ask_levels(DepthLevel* out, int levels) const;
+    
+    // Batched execution: one step of loading what an order on side will read.
+    // Step 0 loads the book, 1 the opposite best level, 2 its queue, 3 the
+    // order at its head; each step only reads what the one before loaded.
+    static constexpr int PREFETCH_STEPS = 4;
+    void prefetch(int step, OrderType side) const;
+    
     // Print order book
-    void print_orderbook() const;
+    void print_orderbook(std::ostream& out) const;
     
     // Set trade callback
     void set_trade_callback(TradeCallback callback) { onTrade = callback; }
+    void set_level_callback(LevelCallback callback) { onLevelChange = callback; }
 
 public:
-    void execute_trade(std::shared_ptr<Order> buyOrder, std::shared_ptr<Order> sellOrder, int quantity);
+    // Fills both orders at the resting order's price and removes whichever is fully filled.
+    // A Trade is only built when a trade callback is installed.
+    void execute_trade(std::shared_ptr<Order> buyOrder, std::shared_ptr<Order> sellOrder, int quantity, double price);
+    
+    // Fills one resting order on its own, for trades whose other side is in another
+    // book (implied matching). Removes the order once fully filled.
+    void fill_resting(const std::shared_ptr<Order>& order, int quantity);
 
 private:
+    double hotWindow = 0.0;
+    uint64_t coldSequence = 0;
+    size_t deadColdBuys = 0;
+    size_t deadColdSells = 0;
+    
+    // Every constrained key per side, so a sweep too small for all of them skips the side
+    std::multiset<int> constrainedBuyKeys;
+    std::multiset<int> constrainedSellKeys;
+    
     void update_market_data();
+    void remove_filled(const std::shared_ptr<Order>& order);
+    void add_constrained_order(const std::shared_ptr<Order>& order);
+    bool remove_constrained_order(const std::shared_ptr<Order>& order);
+    void rekey_constrained_order(const std::shared_ptr<Order>& order, int oldKey);
+    bool is_cold(const Order& order) const;
+    void add_cold_order(std::shared_ptr<Order> order);
+    void rebalance_tiers();
+    template <typename Levels>
+    static void prefetch_touch(const Levels& levels, int step);
+    template <typename Levels>
+    void rebalance_side(Levels& levels, std::vector<ColdOrder>& cold, size_t& dead, OrderType side);
     std::string generate_trade_id();
 };
 
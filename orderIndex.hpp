@@ -0,0 +1,152 @@
+// orderIndex.hpp
+#ifndef ORDERINDEX_HPP
+#define ORDERINDEX_HPP
+
+#include <charconv>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+#include "order.hpp"
+
+// Order ID -> resting order. IDs handed out by allocate_id() are "S" followed
+// by the decimal value of (generation << 32 | slot): a lookup parses the
+// number and indexes the slot array directly, and the generation, bumped each
+// time a slot is reused, rejects IDs of orders that are gone. Any other ID
+// (engine "O" IDs, IDs supplied by replays or feeds) goes to a hash map,
+// which is not consulted at all while it is empty.
+class OrderIndex {
+public:
+    std::string allocate_id() {
+        uint32_t slot;
+        if (!take_free_slot(slot)) {
+            slot = static_cast<uint32_t>(slots.size());
+            slots.emplace_back();
+        }
+        Slot& entry = slots[slot];
+        entry.generation++;
+        entry.state = RESERVED;
+        return "S" + std::to_string((static_cast<uint64_t>(entry.generation) << 32) | slot);
+    }
+
+    // An allocated ID whose order never rested (filled on arrival)
+    void release_id(const std::string& id) {
+        Slot* entry = slot_of(id);
+        if (entry && entry->state == RESERVED) free_slot(*entry);
+    }
+
+    // Also takes back the ID of an order that was just removed, so a modify
+    // can re-insert the order under the ID it already has
+    void insert(const std::shared_ptr<Order>& order) {
+        if (Slot* entry = slot_of(order->orderId)) {
+            entry->order = order;
+            entry->state = LIVE;
+            return;
+        }
+        external[order->orderId] = order;
+    }
+
+    const std::shared_ptr<Order>* find(const std::string& id) const {
+        size_t slot = slot_index(id);
+        if (slot < slots.size()) {
+            return slots[slot].state == LIVE ? &slots[slot].order : nullptr;
+        }
+        if (external.empty()) return nullptr;
+        auto it = external.find(id);
+        return it != external.end() ? &it->second : nullptr;
+    }
+
+    bool erase(const std::string& id) {
+        if (Slot* entry = slot_of(id)) {
+            if (entry->state != LIVE) return false;
+            free_slot(*entry);
+            return true;
+        }
+        return !external.empty() && external.erase(id) > 0;
+    }
+
+    // Batched lookups: step 0 loads the slot a slot ID names, step 1 its order.
+    // Each step only reads what the one before loaded.
+    void prefetch(std::string_view id, int step) const {
+        uint64_t value;
+        if (slots.empty() || !parse_slot_id(id, value)) return;
+        if (step == 0) {
+            if (static_cast<uint32_t>(value) < slots.size()) __builtin_prefetch(&slots[static_cast<uint32_t>(value)]);
+        } else if (step == 1) {
+            size_t slot = slot_index(id);
+            if (slot < slots.size() && slots[slot].order) __builtin_prefetch(slots[slot].order.get());
+        }
+    }
+
+    void reserve(size_t orders, bool slotIds) {
+        if (slotIds) {
+            slots.reserve(orders);
+            freeSlots.reserve(orders);
+        } else {
+            external.reserve(orders);
+        }
+    }
+
+private:
+    enum SlotState : uint8_t { FREE, RESERVED, LIVE };
+
+    struct Slot {
+        std::shared_ptr<Order> order;
+        uint32_t generation = 0;
+        SlotState state = FREE;
+        bool listed = false;    // on freeSlots
+    };
+
+    std::vector<Slot> slots;
+    // Slots freed since, most recent last, each listed at most once. A slot
+    // taken back by insert() stays listed, so freeing it again (every modify
+    // does) does not add another entry; take_free_slot() skips entries that
+    // are no longer free.
+    std::vector<uint32_t> freeSlots;
+    std::unordered_map<std::string, std::shared_ptr<Order>> external;
+
+    // The slot an ID names if it is a slot ID of the slot's current generation,
+    // otherwise slots.size()
+    size_t slot_index(std::string_view id) const {
+        uint64_t value;
+        if (slots.empty() || !parse_slot_id(id, value)) return slots.size();
+
+        uint32_t slot = static_cast<uint32_t>(value);
+        if (slot >= slots.size() || slots[slot].generation != static_cast<uint32_t>(value >> 32)) return slots.size();
+        return slot;
+    }
+
+    static bool parse_slot_id(std::string_view id, uint64_t& value) {
+        if (id.size() < 2 || id[0] != 'S') return false;
+        auto result = std::from_chars(id.data() + 1, id.data() + id.size(), value);
+        return result.ec == std::errc() && result.ptr == id.data() + id.size();
+    }
+
+    Slot* slot_of(const std::string& id) {
+        size_t slot = slot_index(id);
+        return slot < slots.size() ? &slots[slot] : nullptr;
+    }
+
+    bool take_free_slot(uint32_t& slot) {
+        while (!freeSlots.empty()) {
+            slot = freeSlots.back();
+            freeSlots.pop_back();
+            slots[slot].listed = false;
+            if (slots[slot].state == FREE) return true;
+        }
+        return false;
+    }
+
+    void free_slot(Slot& entry) {
+        entry.order.reset();
+        entry.state = FREE;
+        if (!entry.listed) {
+            entry.listed = true;
+            freeSlots.push_back(static_cast<uint32_t>(&entry - slots.data()));
+        }
+    }
+};
+
+#endif
@@ -0,0 +1,246 @@
+// sessionCapture.cpp
+#include "sessionCapture.hpp"
+#include "varint.hpp"
+#include <chrono>
+#include <cstring>
+#include <iostream>
+#include <iterator>
+
+namespace {
+
+constexpr char CAPTURE_MAGIC[8] = {'L', 'O', 'B', 'C', 'A', 'P', 'T', '1'};
+constexpr uint32_t BLOCK_MAGIC = 0x4b4c4243; // "CBLK"
+
+struct CaptureFileHeader {
+    char magic[8];
+    uint32_t version;
+    uint32_t reserved;
+};
+
+struct CaptureBlockHeader {
+    uint32_t magic;
+    uint32_t events;
+    uint32_t payloadBytes;
+    uint32_t checksum;
+    int64_t baseTimestampNs;    // the first event's timestamp delta is against this
+};
+
+int64_t now_ns() {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::system_clock::now().time_since_epoch()).count();
+}
+
+bool decode_block(const uint8_t* in, const uint8_t* end, uint32_t count, int64_t baseTimestampNs,
+                  std::vector<CaptureEvent>& out) {
+    int64_t timestampNs = baseTimestampNs;
+    for (uint32_t i = 0; i < count; ++i) {
+        if (in == end || *in > CAPTURE_CLOSE) return false;
+        CaptureEvent event;
+        event.type = static_cast<CaptureEventType>(*in++);
+
+        uint64_t delta;
+        if (!(in = get_varint(in, end, event.session)) || !(in = get_varint(in, end, delta))) return false;
+        timestampNs += unzigzag(delta);
+        event.timestampNs = timestampNs;
+
+        if (event.type == CAPTURE_DATA) {
+            uint64_t size;
+            if (!(in = get_varint(in, end, size)) || static_cast<uint64_t>(end - in) < size) return false;
+            event.data.assign(reinterpret_cast<const char*>(in), size);
+            in += size;
+        }
+        out.push_back(std::move(event));
+    }
+    return in == end;
+}
+
+} // namespace
+
+SessionCapture::SessionCapture(const std::string& capturePath)
+    : path(capturePath), currentEvents(0), currentBaseNs(0), lastTimestampNs(0), running(false),
+      eventsWritten(0), bytesWritten(0) {
+    current.reserve(BLOCK_BYTES);
+}
+
+SessionCapture::~SessionCapture() {
+    stop();
+}
+
+bool SessionCapture::start() {
+    if (running) return true;
+
+    // One capture per run: session IDs and timing restart with the gateway
+    file.open(path, std::ios::binary | std::ios::trunc);
+    if (!file.is_open()) {
+        std::cerr << "Error: Could not open session capture " << path << std::endl;
+        return false;
+    }
+    CaptureFileHeader header{};
+    std::memcpy(header.magic, CAPTURE_MAGIC, sizeof(CAPTURE_MAGIC));
+    header.version = 1;
+    file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    file.flush();
+
+    running = true;
+    writerThread = std::thread(&SessionCapture::writer_worker, this);
+    return true;
+}
+
+void SessionCapture::stop() {
+    if (!running) return;
+
+    {
+        std::lock_guard<std::mutex> lock(currentMutex);
+        if (currentEvents > 0) submit_current();
+    }
+    {
+        std::lock_guard<std::mutex> lock(queueMutex);
+        running = false;
+    }
+    queueCondition.notify_one();
+    if (writerThread.joinable()) {
+        writerThread.join();
+    }
+    file.close();
+}
+
+void SessionCapture::record_open(uint64_t session) {
+    append(CAPTURE_OPEN, session, nullptr, 0);
+}
+
+void SessionCapture::record_data(uint64_t session, const char* data, size_t size) {
+    append(CAPTURE_DATA, session, data, size);
+}
+
+void SessionCapture::record_close(uint64_t session) {
+    append(CAPTURE_CLOSE, session, nullptr, 0);
+}
+
+void SessionCapture::append(CaptureEventType type, uint64_t session, const char* data, size_t size) {
+    if (!running) return;
+
+    // Stamped before taking the lock; a thread that loses the race writes a
+    // negative delta, so events stay in the order they were appended
+    int64_t timestampNs = now_ns();
+
+    std::lock_guard<std::mutex> lock(currentMutex);
+    if (currentEvents == 0) {
+        currentBaseNs = timestampNs;
+        lastTimestampNs = timestampNs;
+    }
+
+    current.push_back(type);
+    put_varint(current, session);
+    put_varint(current, zigzag(timestampNs - lastTimestampNs));
+    if (type == CAPTURE_DATA) {
+        put_varint(current, size);
+        current.insert(current.end(), data, data + size);
+    }
+    lastTimestampNs = timestampNs;
+    currentEvents++;
+
+    if (current.size() >= BLOCK_BYTES) {
+        submit_current();
+    }
+}
+
+// Caller holds currentMutex
+void SessionCapture::submit_current() {
+    std::vector<uint8_t> next;
+    {
+        std::lock_guard<std::mutex> lock(queueMutex);
+        pending.push({std::move(current), currentEvents, currentBaseNs});
+        if (!freeBlocks.empty()) {
+            next = std::move(freeBlocks.back());
+            freeBlocks.pop_back();
+        }
+    }
+    queueCondition.notify_one();
+
+    current = std::move(next);
+    current.clear();
+    current.reserve(BLOCK_BYTES);
+    currentEvents = 0;
+}
+
+void SessionCapture::writer_worker() {
+    std::unique_lock<std::mutex> lock(queueMutex);
+    while (true) {
+        queueCondition.wait_for(lock, std::chrono::nanoseconds(MAX_BLOCK_AGE_NS),
+                                [this] { return !pending.empty() || !running; });
+        if (pending.empty()) {
+            if (!running) break;
+
+            // Quiet gateway: take whatever has accumulated so it reaches disk
+            // within a bounded delay
+            lock.unlock();
+            {
+                std::lock_guard<std::mutex> currentLock(currentMutex);
+                if (currentEvents > 0) submit_current();
+            }
+            lock.lock();
+            continue;
+        }
+
+        Block block = std::move(pending.front());
+        pending.pop();
+        lock.unlock();
+
+        write_block(block);
+
+        lock.lock();
+        freeBlocks.push_back(std::move(block.payload));
+    }
+}
+
+void SessionCapture::write_block(const Block& block) {
+    CaptureBlockHeader header{};
+    header.magic = BLOCK_MAGIC;
+    header.events = block.events;
+    header.payloadBytes = static_cast<uint32_t>(block.payload.size());
+    header.checksum = checksum(block.payload.data(), block.payload.size());
+    header.baseTimestampNs = block.baseTimestampNs;
+
+    file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    file.write(reinterpret_cast<const char*>(block.payload.data()), block.payload.size());
+    file.flush();
+
+    eventsWritten += block.events;
+    bytesWritten += sizeof(header) + block.payload.size();
+}
+
+bool SessionCapture::read(const std::string& path, std::vector<CaptureEvent>& events) {
+    std::ifstream in(path, std::ios::binary);
+    if (!in.is_open()) {
+        std::cerr << "Error: Could not open session capture " << path << std::endl;
+        return false;
+    }
+    std::vector<uint8_t> bytes((std::istreambuf_iterator<char>(in)), std::istreambuf_iterator<char>());
+
+    CaptureFileHeader header;
+    if (bytes.size() < sizeof(header) ||
+        std::memcmp(bytes.data(), CAPTURE_MAGIC, sizeof(CAPTURE_MAGIC)) != 0) {
+        std::cerr << "Error: " << path << " is not a session capture" << std::endl;
+        return false;
+    }
+
+    // A torn block at the end (crash mid-write) is ignored
+    events.clear();
+    size_t offset = sizeof(header);
+    while (offset + sizeof(CaptureBlockHeader) <= bytes.size()) {
+        CaptureBlockHeader block;
+        std::memcpy(&block, bytes.data() + offset, sizeof(block));
+        const uint8_t* payload = bytes.data() + offset + sizeof(block);
+        if (block.magic != BLOCK_MAGIC || bytes.size() - offset - sizeof(block) < block.payloadBytes ||
+            block.checksum != checksum(payload, block.payloadBytes)) {
+            break;
+        }
+        size_t decoded = events.size();
+        if (!decode_block(payload, payload + block.payloadBytes, block.events, block.baseTimestampNs, events)) {
+            events.erase(events.begin() + decoded, events.end());
+            break;
+        }
+        offset += sizeof(block) + block.payloadBytes;
+    }
+    return true;
+}
@@ -0,0 +1,90 @@
+// sessionCapture.hpp
+#ifndef SESSIONCAPTURE_HPP
+#define SESSIONCAPTURE_HPP
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <fstream>
+#include <mutex>
+#include <queue>
+#include <string>
+#include <thread>
+#include <vector>
+
+enum CaptureEventType : uint8_t { CAPTURE_OPEN = 0, CAPTURE_DATA = 1, CAPTURE_CLOSE = 2 };
+
+// One gateway event as read back from a capture file
+struct CaptureEvent {
+    int64_t timestampNs;    // wall clock when the bytes came off the socket
+    uint64_t session;
+    CaptureEventType type;
+    std::string data;       // DATA: the bytes exactly as received
+};
+
+// Records every inbound byte of every gateway session, with its receive time,
+// so an incident can be re-driven later with the original timing and the
+// original interleaving across connections.
+//
+// The file is a header followed by checksummed blocks. Each event in a block
+// is a type byte, the session ID and the zigzag timestamp delta from the
+// previous event as varints, and for DATA a varint length and the raw bytes.
+// Connection threads only encode into the current block under a short lock;
+// full or aged blocks are written by a background thread.
+class SessionCapture {
+public:
+    static constexpr size_t BLOCK_BYTES = 64 * 1024;
+    static constexpr int64_t MAX_BLOCK_AGE_NS = 100000000;
+
+    explicit SessionCapture(const std::string& path);
+    ~SessionCapture();
+
+    bool start();
+    void stop();
+
+    // Any connection thread; session IDs are assigned by the gateway
+    void record_open(uint64_t session);
+    void record_data(uint64_t session, const char* data, size_t size);
+    void record_close(uint64_t session);
+
+    size_t get_events_written() const { return eventsWritten.load(); }
+    size_t get_bytes_written() const { return bytesWritten.load(); }
+
+    // Reads a whole capture in file order; stops at a torn or corrupt block
+    static bool read(const std::string& path, std::vector<CaptureEvent>& events);
+
+private:
+    std::string path;
+
+    // Block being filled, shared by the connection threads
+    std::mutex currentMutex;
+    std::vector<uint8_t> current;
+    uint32_t currentEvents;
+    int64_t currentBaseNs;
+    int64_t lastTimestampNs;
+
+    // Hand-off to the writer thread; written blocks come back through freeBlocks
+    struct Block {
+        std::vector<uint8_t> payload;
+        uint32_t events;
+        int64_t baseTimestampNs;
+    };
+    std::queue<Block> pending;
+    std::vector<std::vector<uint8_t>> freeBlocks;
+    std::mutex queueMutex;
+    std::condition_variable queueCondition;
+    std::thread writerThread;
+    std::atomic<bool> running;
+
+    // Owned by the writer thread
+    std::ofstream file;
+    std::atomic<size_t> eventsWritten;
+    std::atomic<size_t> bytesWritten;
+
+    void append(CaptureEventType type, uint64_t session, const char* data, size_t size);
+    void submit_current();
+    void writer_worker();
+    void write_block(const Block& block);
+};
+
+#endif
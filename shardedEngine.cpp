@@ -0,0 +1,359 @@
+// shardedEngine.cpp
+#include "shardedEngine.hpp"
+#include <cstring>
+#include <functional>
+
+namespace {
+
+// Copies into a fixed field; false if it does not fit with its terminator
+template <size_t N>
+bool copy_field(char (&field)[N], const std::string& value) {
+    if (value.size() >= N) return false;
+    std::memcpy(field, value.data(), value.size());
+    field[value.size()] = '\0';
+    return true;
+}
+
+} // namespace
+
+ShardedEngine::ShardedEngine(size_t shardCount, const InstrumentMaster* master, double reservedLimit, size_t ringCapacity)
+    : instruments(master), reservedNotionalLimit(reservedLimit), running(false) {
+    if (shardCount == 0) shardCount = 1;
+    for (size_t i = 0; i < shardCount; ++i) {
+        shards.emplace_back(new Shard(ringCapacity));
+    }
+}
+
+ShardedEngine::~ShardedEngine() {
+    stop();
+}
+
+void ShardedEngine::start() {
+    if (running) return;
+
+    running = true;
+    for (auto& shard : shards) {
+        Shard* owner = shard.get();
+        shard->thread = std::thread([this, owner]() { shard_worker(*owner); });
+    }
+}
+
+void ShardedEngine::stop() {
+    if (!running) return;
+
+    running = false;
+    for (auto& shard : shards) {
+        if (shard->thread.joinable()) shard->thread.join();
+    }
+}
+
+size_t ShardedEngine::shard_of(const std::string& symbol) const {
+    return std::hash<std::string>()(symbol) % shards.size();
+}
+
+void ShardedEngine::send(size_t shard, const ShardCommand& command) {
+    // A full ring means the shard is behind; drain our replies meanwhile so it
+    // can never be stuck pushing to us while we wait on it
+    while (!shards[shard]->inbound.try_push(command)) {
+        if (poll() == 0) std::this_thread::yield();
+    }
+}
+
+uint64_t ShardedEngine::submit_order(const std::string& symbol, OrderType side, double price, int quantity) {
+    uint64_t requestId = ++requestCounter;
+
+    ShardCommand command{};
+    command.kind = ShardCommand::NEW_ORDER;
+    command.side = side;
+    command.quantity = quantity;
+    command.price = price;
+    command.requestId = requestId;
+    if (!copy_field(command.symbol, symbol)) {
+        if (onOrder) onOrder({requestId, false, ""});
+        return requestId;
+    }
+
+    send(shard_of(symbol), command);
+    return requestId;
+}
+
+uint64_t ShardedEngine::cancel_order(const std::string& symbol, const std::string& orderId) {
+    uint64_t requestId = ++requestCounter;
+
+    ShardCommand command{};
+    command.kind = ShardCommand::CANCEL;
+    command.requestId = requestId;
+    if (!copy_field(command.symbol, symbol) || !copy_field(command.orderId, orderId)) {
+        if (onOrder) onOrder({requestId, false, ""});
+        return requestId;
+    }
+
+    send(shard_of(symbol), command);
+    return requestId;
+}
+
+uint64_t ShardedEngine::submit_basket(const std::vector<BasketLeg>& legs) {
+    uint64_t basketId = ++requestCounter;
+
+    std::vector<ShardCommand> commands(legs.size());
+    std::vector<size_t> legShard(legs.size());
+    std::vector<uint32_t> shardLegs(shards.size(), 0);
+    bool ok = !legs.empty();
+    for (size_t i = 0; ok && i < legs.size(); ++i) {
+        ShardCommand& command = commands[i];
+        command.kind = ShardCommand::BASKET_PREPARE;
+        command.side = legs[i].side;
+        command.quantity = legs[i].quantity;
+        command.price = legs[i].price;
+        command.basketId = basketId;
+        command.legIndex = static_cast<uint32_t>(i);
+        ok = copy_field(command.symbol, legs[i].symbol);
+
+        legShard[i] = shard_of(legs[i].symbol);
+        shardLegs[legShard[i]]++;
+    }
+    if (!ok) {
+        if (onBasket) onBasket({basketId, false, {}});
+        return basketId;
+    }
+
+    PendingBasket& basket = baskets[basketId];
+    basket.legsPending = legs.size();
+    basket.orderIds.resize(legs.size());
+    basket.symbols.reserve(legs.size());
+    for (const BasketLeg& leg : legs) {
+        basket.symbols.push_back(leg.symbol);
+    }
+    for (size_t s = 0; s < shards.size(); ++s) {
+        if (shardLegs[s] > 0) basket.shards.push_back(s);
+    }
+    basket.votesPending = basket.shards.size();
+
+    // Phase one: every shard gets all of its legs, then votes once
+    for (size_t i = 0; i < commands.size(); ++i) {
+        commands[i].shardLegs = shardLegs[legShard[i]];
+        send(legShard[i], commands[i]);
+    }
+    return basketId;
+}
+
+size_t ShardedEngine::poll() {
+    size_t handled = 0;
+    ShardReply reply;
+    for (auto& shard : shards) {
+        while (shard->outbound.try_pop(reply)) {
+            handle_reply(reply);
+            handled++;
+        }
+    }
+    return handled;
+}
+
+void ShardedEngine::handle_reply(const ShardReply& reply) {
+    switch (reply.kind) {
+    case ShardReply::ORDER_ACK:
+    case ShardReply::CANCEL_ACK:
+        // Cancels of placed legs of a failed basket are not client requests
+        if (reply.basketId != 0) break;
+        if (onOrder) onOrder({reply.requestId, reply.ok, reply.orderId});
+        break;
+    case ShardReply::BASKET_VOTE: {
+        auto it = baskets.find(reply.basketId);
+        if (it == baskets.end()) return;
+
+        PendingBasket& basket = it->second;
+        basket.ok = basket.ok && reply.ok;
+        if (--basket.votesPending == 0) finish_votes(reply.basketId, basket);
+        break;
+    }
+    case ShardReply::BASKET_LEG_ACK: {
+        auto it = baskets.find(reply.basketId);
+        if (it == baskets.end()) return;
+
+        PendingBasket& basket = it->second;
+        basket.orderIds[reply.legIndex] = reply.orderId;
+        if (!reply.ok && (basket.legsOk || static_cast<int>(reply.legIndex) < basket.failedLeg)) {
+            basket.legsOk = false;
+            basket.failedLeg = static_cast<int>(reply.legIndex);
+        }
+        if (--basket.legsPending == 0) {
+            if (!basket.legsOk) cancel_legs(reply.basketId, basket);
+            BasketResult result{reply.basketId, basket.legsOk, std::move(basket.orderIds), basket.failedLeg};
+            baskets.erase(it);
+            if (onBasket) onBasket(result);
+        }
+        break;
+    }
+    }
+}
+
+void ShardedEngine::finish_votes(uint64_t basketId, PendingBasket& basket) {
+    // Phase two: decisions go out back to back so the legs are released together
+    ShardCommand command{};
+    command.kind = basket.ok ? ShardCommand::BASKET_COMMIT : ShardCommand::BASKET_ABORT;
+    command.basketId = basketId;
+    for (size_t shard : basket.shards) {
+        send(shard, command);
+    }
+
+    if (!basket.ok) {
+        baskets.erase(basketId);
+        if (onBasket) onBasket({basketId, false, {}});
+    }
+}
+
+// All-or-none also after commit: a leg rejected by its book takes the others out
+void ShardedEngine::cancel_legs(uint64_t basketId, const PendingBasket& basket) {
+    for (size_t i = 0; i < basket.orderIds.size(); ++i) {
+        if (basket.orderIds[i].empty()) continue;
+
+        ShardCommand command{};
+        command.kind = ShardCommand::CANCEL;
+        command.basketId = basketId;
+        copy_field(command.symbol, basket.symbols[i]);
+        copy_field(command.orderId, basket.orderIds[i]);
+        send(shard_of(basket.symbols[i]), command);
+    }
+}
+
+void ShardedEngine::shard_worker(Shard& shard) {
+    std::vector<ShardCommand> window(batchWindow);
+    while (running) {
+        size_t count = 0;
+        while (count < window.size() && shard.inbound.try_pop(window[count])) {
+            count++;
+        }
+        if (count == 0) {
+            std::this_thread::yield();
+        } else if (count == 1) {
+            process(shard, window[0]);
+        } else {
+            process_batch(shard, window.data(), count);
+        }
+    }
+}
+
+void ShardedEngine::process_batch(Shard& shard, const ShardCommand* commands, size_t count) {
+    // Find every command's book first (basket commands are not prefetched), then
+    // walk the window once per prefetch step: each step reads only lines the
+    // previous pass asked for, which have had the rest of the window to arrive
+    Book* books[MAX_BATCH_WINDOW];
+    for (size_t i = 0; i < count; ++i) {
+        const ShardCommand& command = commands[i];
+        bool single = command.kind == ShardCommand::NEW_ORDER || command.kind == ShardCommand::CANCEL;
+        books[i] = single ? &book(shard, command.symbol) : nullptr;
+    }
+    for (int step = 0; step < MatchingEngine::PREFETCH_STEPS; ++step) {
+        for (size_t i = 0; i < count; ++i) {
+            if (!books[i]) continue;
+            const ShardCommand& command = commands[i];
+            if (command.kind == ShardCommand::CANCEL) {
+                books[i]->engine->prefetch(step, command.side, command.orderId);
+            } else {
+                books[i]->engine->prefetch(step, command.side);
+            }
+        }
+    }
+
+    for (size_t i = 0; i < count; ++i) {
+        process(shard, commands[i], books[i]);
+    }
+}
+
+void ShardedEngine::reply(Shard& shard, const ShardReply& message) {
+    while (!shard.outbound.try_push(message)) {
+        if (!running) return;
+        std::this_thread::yield();
+    }
+}
+
+ShardedEngine::Book& ShardedEngine::book(Shard& shard, const char* symbol) {
+    Book& book = shard.books[symbol];
+    if (!book.engine) {
+        book.engine.reset(new MatchingEngine());
+        book.engine->set_instrument_master(instruments);
+        book.engine->set_slot_order_ids(slotOrderIds);
+        if (onExecution) book.engine->set_execution_callback(onExecution);
+        book.symbolId = book.engine->symbol_id(symbol);
+    }
+    return book;
+}
+
+bool ShardedEngine::validate_leg(const ShardCommand& command) const {
+    if (command.quantity <= 0 || command.price <= 0) return false;
+    if (!instruments) return true;
+
+    uint32_t symbolId = instruments->find(command.symbol);
+    return instruments->validate(symbolId, InstrumentMaster::to_price_units(command.price), command.quantity) == INSTRUMENT_OK;
+}
+
+void ShardedEngine::process(Shard& shard, const ShardCommand& command, Book* target) {
+    ShardReply message{};
+    message.requestId = command.requestId;
+    message.basketId = command.basketId;
+    message.legIndex = command.legIndex;
+
+    switch (command.kind) {
+    case ShardCommand::NEW_ORDER: {
+        Book& symbolBook = target ? *target : book(shard, command.symbol);
+        std::string orderId = symbolBook.engine->submit_order(command.side, command.price, command.quantity,
+                                                              command.symbol, symbolBook.symbolId, "SHARD");
+        message.kind = ShardReply::ORDER_ACK;
+        message.ok = !orderId.empty();
+        copy_field(message.orderId, orderId);
+        reply(shard, message);
+        break;
+    }
+    case ShardCommand::CANCEL:
+        message.kind = ShardReply::CANCEL_ACK;
+        message.ok = (target ? *target : book(shard, command.symbol)).engine->cancel_order(command.orderId);
+        std::memcpy(message.orderId, command.orderId, sizeof(message.orderId));
+        reply(shard, message);
+        break;
+    case ShardCommand::BASKET_PREPARE: {
+        // Validate and reserve now; nothing touches the book until commit
+        PreparedBasket& prepared = shard.prepared[command.basketId];
+        prepared.expected = command.shardLegs;
+        prepared.legs.push_back(command);
+        prepared.ok = prepared.ok && validate_leg(command);
+        prepared.notional += command.price * command.quantity;
+        if (prepared.legs.size() < prepared.expected) break;
+
+        if (prepared.ok && reservedNotionalLimit > 0 &&
+            shard.reservedNotional + prepared.notional > reservedNotionalLimit) {
+            prepared.ok = false;
+        }
+        if (prepared.ok) {
+            shard.reservedNotional += prepared.notional;
+        }
+        message.kind = ShardReply::BASKET_VOTE;
+        message.ok = prepared.ok;
+        reply(shard, message);
+        break;
+    }
+    case ShardCommand::BASKET_COMMIT:
+    case ShardCommand::BASKET_ABORT: {
+        auto it = shard.prepared.find(command.basketId);
+        if (it == shard.prepared.end()) break;
+
+        PreparedBasket& prepared = it->second;
+        if (prepared.ok) {
+            shard.reservedNotional -= prepared.notional;
+        }
+        if (command.kind == ShardCommand::BASKET_COMMIT) {
+            for (const ShardCommand& leg : prepared.legs) {
+                Book& legBook = book(shard, leg.symbol);
+                std::string orderId = legBook.engine->submit_order(leg.side, leg.price, leg.quantity,
+                                                                   leg.symbol, legBook.symbolId, "BASKET");
+                message.kind = ShardReply::BASKET_LEG_ACK;
+                message.ok = !orderId.empty();
+                message.legIndex = leg.legIndex;
+                copy_field(message.orderId, orderId);
+                reply(shard, message);
+            }
+        }
+        shard.prepared.erase(it);
+        break;
+    }
+    }
+}
@@ -0,0 +1,183 @@
+// shardedEngine.hpp
+#ifndef SHARDEDENGINE_HPP
+#define SHARDEDENGINE_HPP
+
+#include "matchingEngine.hpp"
+#include "spscRing.hpp"
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+// Fixed-size messages on the gateway -> shard rings
+struct ShardCommand {
+    enum Kind : uint8_t { NEW_ORDER, CANCEL, BASKET_PREPARE, BASKET_COMMIT, BASKET_ABORT };
+
+    Kind kind;
+    OrderType side;
+    int32_t quantity;
+    double price;
+    uint64_t requestId;
+    uint64_t basketId;
+    uint32_t legIndex;      // BASKET_PREPARE: index in the whole basket
+    uint32_t shardLegs;     // BASKET_PREPARE: legs of this basket on this shard
+    char symbol[16];
+    char orderId[24];       // CANCEL
+};
+
+// Fixed-size messages on the shard -> gateway rings
+struct ShardReply {
+    enum Kind : uint8_t { ORDER_ACK, CANCEL_ACK, BASKET_VOTE, BASKET_LEG_ACK };
+
+    Kind kind;
+    bool ok;
+    uint64_t requestId;
+    uint64_t basketId;
+    uint32_t legIndex;
+    char orderId[24];
+};
+
+// Symbols are spread over shard threads, each owning one MatchingEngine per
+// symbol. The gateway thread (the one calling submit_*, cancel_order and poll)
+// talks to every shard over a pair of SPSC rings.
+//
+// With a batch window, a shard takes up to that many queued commands at once
+// and loads the book data each one will touch in a few interleaved prefetch
+// passes over the window before executing any, so the cache misses of
+// different books overlap instead of stalling one after another. Commands
+// still execute, and reply, in ring order.
+//
+// Baskets are all-or-none across shards with a two-phase protocol on the same
+// rings: each affected shard validates its legs and reserves their notional
+// (prepare) and votes; once every vote is in, the gateway sends commit to all
+// shards back to back, or abort if any shard said no. Shards never wait on
+// each other or on the gateway, so single orders keep flowing while a basket
+// is in flight.
+class ShardedEngine {
+public:
+    struct BasketLeg {
+        std::string symbol;
+        OrderType side;
+        double price;
+        int quantity;
+    };
+    struct OrderResult {
+        uint64_t requestId;
+        bool accepted;
+        std::string orderId;
+    };
+    // A basket that passed the vote can still have a leg rejected by its book at
+    // commit. It is then reported as not accepted with failedLeg set, and the
+    // legs that were placed are cancelled; fills they already got stand.
+    struct BasketResult {
+        uint64_t basketId;
+        bool accepted;
+        std::vector<std::string> orderIds;  // per leg, in basket order; empty if not placed
+        int failedLeg = -1;                 // first leg rejected at commit
+    };
+    using OrderCallback = std::function<void(const OrderResult&)>;
+    using BasketCallback = std::function<void(const BasketResult&)>;
+
+    // reservedNotionalLimit caps the notional of prepared, uncommitted basket legs
+    // per shard; 0 means no cap
+    ShardedEngine(size_t shards, const InstrumentMaster* instruments = nullptr,
+                  double reservedNotionalLimit = 0.0, size_t ringCapacity = 65536);
+    ~ShardedEngine();
+
+    void start();
+    void stop();
+
+    size_t shard_count() const { return shards.size(); }
+    size_t shard_of(const std::string& symbol) const;
+
+    // Gateway thread only. Each returns a request (or basket) ID echoed in the result.
+    uint64_t submit_order(const std::string& symbol, OrderType side, double price, int quantity);
+    uint64_t cancel_order(const std::string& symbol, const std::string& orderId);
+    uint64_t submit_basket(const std::vector<BasketLeg>& legs);
+
+    // Gateway thread only: drains shard replies, runs the basket protocol and the
+    // callbacks. Returns the number of replies handled.
+    size_t poll();
+
+    void set_order_callback(OrderCallback callback) { onOrder = std::move(callback); }
+    void set_basket_callback(BasketCallback callback) { onBasket = std::move(callback); }
+
+    // Runs on shard threads; must be set before start()
+    void set_execution_callback(MatchingEngine::ExecutionCallback callback) { onExecution = std::move(callback); }
+
+    // Commands a shard takes per batch (1 = one at a time); set before start()
+    static constexpr size_t MAX_BATCH_WINDOW = 64;
+    void set_batch_window(size_t commands) { batchWindow = std::max<size_t>(1, std::min(commands, MAX_BATCH_WINDOW)); }
+
+    // Slot/generation order IDs in every book (see MatchingEngine); set before start()
+    void set_slot_order_ids(bool enabled) { slotOrderIds = enabled; }
+
+private:
+    struct PreparedBasket {
+        std::vector<ShardCommand> legs;
+        uint32_t expected = 0;
+        bool ok = true;
+        double notional = 0.0;
+    };
+    // One symbol's engine on a shard, with the symbol's ID resolved when the
+    // book was created
+    struct Book {
+        std::unique_ptr<MatchingEngine> engine;
+        uint32_t symbolId = InstrumentMaster::INVALID_SYMBOL_ID;
+    };
+    struct Shard {
+        SpscRing<ShardCommand> inbound;
+        SpscRing<ShardReply> outbound;
+        std::thread thread;
+
+        // Owned by the shard thread
+        std::unordered_map<std::string, Book> books;
+        std::unordered_map<uint64_t, PreparedBasket> prepared;
+        double reservedNotional = 0.0;
+
+        explicit Shard(size_t capacity) : inbound(capacity), outbound(capacity) {}
+    };
+    struct PendingBasket {
+        std::vector<size_t> shards;
+        size_t votesPending = 0;
+        bool ok = true;
+        size_t legsPending = 0;
+        bool legsOk = true;
+        int failedLeg = -1;
+        std::vector<std::string> orderIds;
+        std::vector<std::string> symbols;   // per leg, to cancel placed legs
+    };
+
+    std::vector<std::unique_ptr<Shard>> shards;
+    const InstrumentMaster* instruments;
+    double reservedNotionalLimit;
+    std::atomic<bool> running;
+    MatchingEngine::ExecutionCallback onExecution;
+    size_t batchWindow = 1;
+    bool slotOrderIds = false;
+
+    // Owned by the gateway thread
+    uint64_t requestCounter = 0;
+    std::unordered_map<uint64_t, PendingBasket> baskets;
+    OrderCallback onOrder;
+    BasketCallback onBasket;
+
+    void send(size_t shard, const ShardCommand& command);
+    void handle_reply(const ShardReply& reply);
+    void finish_votes(uint64_t basketId, PendingBasket& basket);
+    void cancel_legs(uint64_t basketId, const PendingBasket& basket);
+
+    void shard_worker(Shard& shard);
+    void process_batch(Shard& shard, const ShardCommand* commands, size_t count);
+    void process(Shard& shard, const ShardCommand& command, Book* target = nullptr);
+    void reply(Shard& shard, const ShardReply& message);
+    Book& book(Shard& shard, const char* symbol);
+    bool validate_leg(const ShardCommand& command) const;
+};
+
+#endif
@@ -1,8 +1,78 @@
 #include "simple_server.hpp"
 #include <cstring>
 #include <algorithm>
+#include <chrono>
+#include <csignal>
+#ifdef __linux__
+#include <netinet/tcp.h>
+#include <linux/errqueue.h>
+#include <linux/net_tstamp.h>
+#endif
 
-SimpleServer::SimpleServer() : serverSocket(-1), running(false) {
+namespace {
+
+// Session whose request this thread is handling; its responses are timestamped
+thread_local ClientSession* handlingSession = nullptr;
+
+// Stamped sends a session may have outstanding before the oldest is given up on
+constexpr size_t MAX_PENDING_TX = 1024;
+
+int64_t now_ns() {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::system_clock::now().time_since_epoch()).count();
+}
+
+bool enable_kernel_timestamps(int socket) {
+#ifdef __linux__
+    // Nagle would coalesce back-to-back responses into one segment, which gets
+    // a single transmit timestamp for several stamped sends
+    int noDelay = 1;
+    // OPT_ID tags each transmit stamp with the stream offset of the stamped
+    // send's last byte, counted from here
+    int flags = SOF_TIMESTAMPING_RX_SOFTWARE | SOF_TIMESTAMPING_SOFTWARE | SOF_TIMESTAMPING_OPT_TSONLY |
+                SOF_TIMESTAMPING_OPT_ID;
+    return setsockopt(socket, IPPROTO_TCP, TCP_NODELAY, &noDelay, sizeof(noDelay)) == 0 &&
+           setsockopt(socket, SOL_SOCKET, SO_TIMESTAMPING, &flags, sizeof(flags)) == 0;
+#else
+    (void)socket;
+    return false;
+#endif
+}
+
+#ifdef __linux__
+// Software timestamp carried by a received message or error queue entry, 0 if none
+int64_t kernel_timestamp_ns(struct msghdr& message) {
+    for (struct cmsghdr* header = CMSG_FIRSTHDR(&message); header; header = CMSG_NXTHDR(&message, header)) {
+        if (header->cmsg_level == SOL_SOCKET && header->cmsg_type == SCM_TIMESTAMPING) {
+            struct scm_timestamping stamps;
+            std::memcpy(&stamps, CMSG_DATA(header), sizeof(stamps));
+            return static_cast<int64_t>(stamps.ts[0].tv_sec) * 1000000000 + stamps.ts[0].tv_nsec;
+        }
+    }
+    return 0;
+}
+
+// The OPT_ID key of a transmit timestamp on the error queue
+bool timestamp_key(struct msghdr& message, uint32_t& key) {
+    for (struct cmsghdr* header = CMSG_FIRSTHDR(&message); header; header = CMSG_NXTHDR(&message, header)) {
+        if ((header->cmsg_level == SOL_IP && header->cmsg_type == IP_RECVERR) ||
+            (header->cmsg_level == SOL_IPV6 && header->cmsg_type == IPV6_RECVERR)) {
+            struct sock_extended_err error;
+            std::memcpy(&error, CMSG_DATA(header), sizeof(error));
+            if (error.ee_errno == ENOMSG && error.ee_origin == SO_EE_ORIGIN_TIMESTAMPING) {
+                key = error.ee_data;
+                return true;
+            }
+        }
+    }
+    return false;
+}
+#endif
+
+} // namespace
+
+SimpleServer::SimpleServer()
+    : serverSocket(-1), running(false), nextSessionId(0), capture(nullptr), kernelTimestamping(false) {
 }
 
 SimpleServer::~SimpleServer() {
@@ -10,6 +80,9 @@ SimpleServer::~SimpleServer() {
 }
 
 bool SimpleServer::start(int port) {
+    // A client that hangs up with responses still in flight must not kill the process
+    signal(SIGPIPE, SIG_IGN);
+    
     // Create socket
     serverSocket = socket(AF_INET, SOCK_STREAM, 0);
     if (serverSocket < 0) {
@@ -54,14 +127,17 @@ void SimpleServer::stop() {
         running = false;
         
         // Close all client connections
-        std::lock_guard<std::mutex> lock(clientMutex);
-        for (int clientSocket : clientSockets) {
-            close(clientSocket);
+        {
+            std::lock_guard<std::mutex> lock(clientMutex);
+            for (int clientSocket : clientSockets) {
+                close(clientSocket);
+            }
+            clientSockets.clear();
         }
-        clientSockets.clear();
         
-        // Close server socket
+        // Close server socket; closing alone does not wake a thread blocked in accept()
         if (serverSocket >= 0) {
+            shutdown(serverSocket, SHUT_RDWR);
             close(serverSocket);
             serverSocket = -1;
         }
@@ -113,51 +189,106 @@ void SimpleServer::serverWorker() {
 }
 
 void SimpleServer::handleClient(int clientSocket) {
-    char buffer[1024];
+    char buffer[4096];
+    ClientSession session(clientSocket, ++nextSessionId);
+    if (kernelTimestamping) {
+        // Registered before any broadcast can write uncounted bytes after OPT_ID
+        std::lock_guard<std::mutex> lock(clientMutex);
+        session.kernelTimestamps = enable_kernel_timestamps(clientSocket);
+        if (session.kernelTimestamps) {
+            timestampedSessions[clientSocket] = &session;
+        }
+    }
+    if (capture) {
+        capture->record_open(session.id);
+    }
     
     // Send welcome message
     std::string welcome = createJsonResponse("welcome", "Connected to Limit Order Book Trading System");
-    sendMessage(clientSocket, welcome);
+    if (session.kernelTimestamps) {
+        send_counted(session, welcome + "\n");
+    } else {
+        sendMessage(clientSocket, welcome);
+    }
+    handlingSession = &session;
     
     while (running) {
-        memset(buffer, 0, sizeof(buffer));
-        int bytesReceived = recv(clientSocket, buffer, sizeof(buffer) - 1, 0);
+        int bytesReceived = receive(session, buffer, sizeof(buffer));
         
         if (bytesReceived <= 0) {
             break; // Client disconnected
         }
+        if (capture) {
+            capture->record_data(session.id, buffer, bytesReceived);
+        }
         
-        std::string message(buffer);
-        
-        // Simple message parsing (in a real implementation, you'd use a proper JSON parser)
-        if (message.find("submit_order") != std::string::npos) {
-            handle_order_submission(message, clientSocket);
-        } else if (message.find("cancel_order") != std::string::npos) {
-            // Extract order ID from message
-            size_t start = message.find("orderId");
-            if (start != std::string::npos) {
-                start = message.find(":", start) + 1;
-                size_t end = message.find(",", start);
-                if (end == std::string::npos) end = message.find("}", start);
-                std::string orderId = message.substr(start, end - start);
-                // Remove quotes
-                orderId.erase(std::remove(orderId.begin(), orderId.end(), '"'), orderId.end());
-                handle_order_cancellation(orderId, clientSocket);
-            }
+        // Messages are newline-delimited so clients can pipeline them; a trailing
+        // message without a newline is accepted once it looks complete
+        session.inbound.append(buffer, bytesReceived);
+        size_t start = 0;
+        size_t newline;
+        while ((newline = session.inbound.find('\n', start)) != std::string::npos) {
+            handleMessage(session.inbound.substr(start, newline - start), session);
+            start = newline + 1;
+        }
+        session.inbound.erase(0, start);
+        if (!session.inbound.empty() && session.inbound.back() == '}') {
+            handleMessage(session.inbound, session);
+            session.inbound.clear();
         }
     }
     
+    handlingSession = nullptr;
+    if (capture) {
+        capture->record_close(session.id);
+    }
+    
     // Remove client from set
     {
         std::lock_guard<std::mutex> lock(clientMutex);
         clientSockets.erase(clientSocket);
+        timestampedSessions.erase(clientSocket);
     }
     
     close(clientSocket);
     std::cout << "Client disconnected. Total connections: " << clientSockets.size() << std::endl;
 }
 
-void SimpleServer::handle_order_submission(const std::string& orderData, int clientSocket) {
+void SimpleServer::handleMessage(const std::string& message, ClientSession& session) {
+    // Stages a rejected request never reached are reported as 0
+    session.sequencedNs = 0;
+    session.matchedNs = 0;
+    
+    // Simple message parsing (in a real implementation, you'd use a proper JSON parser)
+    if (message.find("submit_order") != std::string::npos) {
+        handle_order_submission(message, session);
+    } else if (message.find("cancel_order") != std::string::npos) {
+        handle_order_cancellation(message, session);
+    } else if (message.find("modify_order") != std::string::npos) {
+        handle_order_modification(message, session);
+    } else if (message.find("get_metrics") != std::string::npos) {
+        handle_metrics_request(message, session.socket);
+    } else if (message.find("get_latency") != std::string::npos) {
+        handle_latency_request(session.socket);
+    } else if (message.find("set_timestamps") != std::string::npos) {
+        handle_timestamps_request(message, session);
+    }
+}
+
+void SimpleServer::handle_order_submission(const std::string& orderData, ClientSession& session) {
+    int clientSocket = session.socket;
+    
+    // A ClOrdID seen before on this session gets the original ack and never reaches the engine
+    std::string clOrdId = extract_field(orderData, "clOrdId");
+    if (!clOrdId.empty()) {
+        if (const ClOrdIdTable::Entry* entry = session.orders.find(clOrdId)) {
+            sendMessage(clientSocket, entry->ack);
+            return;
+        }
+    }
+    
+    std::string orderId;
+    std::string response;
     try {
         if (!submitCallback) {
             sendMessage(clientSocket, createJsonResponse("error", "Matching engine not connected"));
@@ -201,41 +332,152 @@ void SimpleServer::handle_order_submission(const std::string& orderData, int cli
         }
         
         if (price <= 0 || quantity <= 0) {
-            sendMessage(clientSocket, createJsonResponse("error", "Invalid price or quantity"));
-            return;
+            response = createJsonResponse("error", "Invalid price or quantity");
+        } else {
+            OrderType type = string_to_order_type(orderType);
+            if (symbol != session.symbol) {
+                session.symbol = symbol;
+                session.symbolId = symbolResolver ? symbolResolver(symbol) : UINT32_MAX;
+            }
+            session.sequencedNs = now_ns();
+            orderId = submitCallback(type, price, quantity, symbol, session.symbolId, clientId);
+            session.matchedNs = now_ns();
+            
+            if (orderId.empty()) {
+                response = createJsonResponse("error", "Failed to submit order");
+            } else {
+                response = "{\"type\":\"order_submitted\",\"orderId\":\"" + orderId +
+                           (clOrdId.empty() ? "" : "\",\"clOrdId\":\"" + clOrdId) + "\",\"status\":\"success\"}";
+            }
         }
         
-        OrderType type = string_to_order_type(orderType);
-        std::string orderId = submitCallback(type, price, quantity, symbol, clientId);
+    } catch (const std::exception& e) {
+        response = createJsonResponse("error", "Error submitting order: " + std::string(e.what()));
+    }
+    
+    // Rejects are remembered too, so a resend gets the same answer
+    if (!clOrdId.empty()) {
+        session.orders.insert(clOrdId, orderId, response);
+    }
+    send_response(session, response);
+}
+
+void SimpleServer::handle_order_cancellation(const std::string& request, ClientSession& session) {
+    int clientSocket = session.socket;
+    try {
+        if (!cancelCallback) {
+            sendMessage(clientSocket, createJsonResponse("error", "Matching engine not connected"));
+            return;
+        }
         
-        if (orderId.empty()) {
-            sendMessage(clientSocket, createJsonResponse("error", "Failed to submit order"));
+        std::string orderId;
+        std::string reference;
+        if (!resolve_order_id(request, session, orderId, reference)) {
+            sendMessage(clientSocket, createJsonResponse("error", "Unknown order " + reference));
             return;
         }
         
-        std::string response = "{\"type\":\"order_submitted\",\"orderId\":\"" + orderId + "\",\"status\":\"success\"}";
-        sendMessage(clientSocket, response);
+        session.sequencedNs = now_ns();
+        bool success = cancelCallback(orderId);
+        session.matchedNs = now_ns();
+        
+        std::string response = "{\"type\":\"order_cancelled\",\"orderId\":\"" + orderId + reference_suffix(request, reference) +
+                               "\",\"status\":\"" + (success ? "success" : "failed") + "\"}";
+        send_response(session, response);
         
     } catch (const std::exception& e) {
-        sendMessage(clientSocket, createJsonResponse("error", "Error submitting order: " + std::string(e.what())));
+        sendMessage(clientSocket, createJsonResponse("error", "Error cancelling order: " + std::string(e.what())));
     }
 }
 
-void SimpleServer::handle_order_cancellation(const std::string& orderId, int clientSocket) {
+void SimpleServer::handle_order_modification(const std::string& request, ClientSession& session) {
+    int clientSocket = session.socket;
     try {
-        if (!cancelCallback) {
+        if (!modifyCallback) {
             sendMessage(clientSocket, createJsonResponse("error", "Matching engine not connected"));
             return;
         }
         
-        bool success = cancelCallback(orderId);
+        std::string orderId;
+        std::string reference;
+        if (!resolve_order_id(request, session, orderId, reference)) {
+            sendMessage(clientSocket, createJsonResponse("error", "Unknown order " + reference));
+            return;
+        }
+        
+        std::string price = extract_field(request, "price");
+        std::string quantity = extract_field(request, "quantity");
+        if (price.empty() || quantity.empty()) {
+            sendMessage(clientSocket, createJsonResponse("error", "Invalid price or quantity"));
+            return;
+        }
         
-        std::string response = "{\"type\":\"order_cancelled\",\"orderId\":\"" + orderId + "\",\"status\":\"" + (success ? "success" : "failed") + "\"}";
-        sendMessage(clientSocket, response);
+        session.sequencedNs = now_ns();
+        bool success = modifyCallback(orderId, std::stod(price), std::stoi(quantity));
+        session.matchedNs = now_ns();
+        
+        std::string response = "{\"type\":\"order_modified\",\"orderId\":\"" + orderId + reference_suffix(request, reference) +
+                               "\",\"status\":\"" + (success ? "success" : "failed") + "\"}";
+        send_response(session, response);
         
     } catch (const std::exception& e) {
-        sendMessage(clientSocket, createJsonResponse("error", "Error cancelling order: " + std::string(e.what())));
+        sendMessage(clientSocket, createJsonResponse("error", "Error modifying order: " + std::string(e.what())));
+    }
+}
+
+bool SimpleServer::resolve_order_id(const std::string& request, const ClientSession& session,
+                                    std::string& orderId, std::string& reference) {
+    // Either the engine's orderId or one of this session's own ClOrdIDs
+    reference = extract_field(request, "clOrdId");
+    if (reference.empty()) {
+        orderId = extract_field(request, "orderId");
+        reference = orderId;
+        return !orderId.empty();
+    }
+    
+    const ClOrdIdTable::Entry* entry = session.orders.find(reference);
+    if (!entry || entry->orderId.empty()) return false;
+    orderId = entry->orderId;
+    return true;
+}
+
+std::string SimpleServer::reference_suffix(const std::string& request, const std::string& reference) {
+    return (request.find("\"clOrdId\"") == std::string::npos) ? "" : "\",\"clOrdId\":\"" + reference;
+}
+
+void SimpleServer::handle_metrics_request(const std::string& request, int clientSocket) {
+    if (!metricsCallback) {
+        sendMessage(clientSocket, createJsonResponse("error", "Flow metrics not enabled"));
+        return;
     }
+    
+    // Optional "symbol"; without it every symbol is returned
+    std::string symbol = extract_field(request, "symbol");
+    
+    std::string response = "{\"type\":\"metrics\",\"symbols\":[";
+    auto metrics = metricsCallback(symbol);
+    for (size_t i = 0; i < metrics.size(); ++i) {
+        if (i > 0) response += ',';
+        response += flow_metrics_to_json(metrics[i].first, metrics[i].second);
+    }
+    response += "]}";
+    sendMessage(clientSocket, response);
+}
+
+void SimpleServer::handle_latency_request(int clientSocket) {
+    std::string response = "{\"type\":\"latency\",\"kernelTimestamps\":" +
+                           std::string(kernelTimestamping ? "true" : "false") +
+                           ",\"socketQueue\":" + histogram_to_json(latency.socketQueue) +
+                           ",\"engine\":" + histogram_to_json(latency.engine) +
+                           ",\"transmit\":" + histogram_to_json(latency.transmit) +
+                           ",\"wireToWire\":" + histogram_to_json(latency.wireToWire) + "}";
+    sendMessage(clientSocket, response);
+}
+
+void SimpleServer::handle_timestamps_request(const std::string& request, ClientSession& session) {
+    session.ackTimestamps = extract_field(request, "enabled") != "false";
+    sendMessage(session.socket, std::string("{\"type\":\"timestamps\",\"enabled\":") +
+                                (session.ackTimestamps ? "true" : "false") + "}");
 }
 
 void SimpleServer::broadcast_trade(const Trade& trade) {
@@ -247,6 +489,41 @@ void SimpleServer::broadcast_trade(const Trade& trade) {
     broadcastMessage(tradeData);
 }
 
+void SimpleServer::broadcast_execution(const ExecutionReport& report) {
+    std::string executionData;
+    executionData.reserve(160 + report.fills.size() * 64);
+    executionData += "{\"type\":\"execution\",\"executionId\":\"" + report.executionId +
+                     "\",\"orderId\":\"" + report.orderId +
+                     "\",\"symbol\":\"" + report.symbol +
+                     "\",\"side\":\"" + order_type_to_string(report.side) +
+                     "\",\"filledQuantity\":" + std::to_string(report.filledQuantity) +
+                     ",\"remainingQuantity\":" + std::to_string(report.remainingQuantity) +
+                     ",\"averagePrice\":" + std::to_string(report.averagePrice) +
+                     ",\"worstPrice\":" + std::to_string(report.worstPrice) +
+                     ",\"levels\":" + std::to_string(report.levelsTouched) +
+                     ",\"fills\":[";
+    
+    for (size_t i = 0; i < report.fills.size(); ++i) {
+        const Fill& fill = report.fills[i];
+        if (i > 0) executionData += ',';
+        executionData += "{\"orderId\":\"" + fill.passiveOrderId +
+                         "\",\"price\":" + std::to_string(fill.price) +
+                         ",\"quantity\":" + std::to_string(fill.quantity) + "}";
+    }
+    executionData += "]}";
+    
+    // Fills caused by the session this thread is handling carry its breakdown,
+    // with the engine's execution time as the matched stage
+    ClientSession* session = handlingSession;
+    if (session && session->ackTimestamps) {
+        int64_t matchedNs = std::chrono::duration_cast<std::chrono::nanoseconds>(
+            report.timestamp.time_since_epoch()).count();
+        broadcastMessage(executionData, session, matchedNs);
+        return;
+    }
+    broadcastMessage(executionData);
+}
+
 void SimpleServer::broadcast_orderbook_update(const std::string& symbol, double bestBid, double bestAsk, int bidSize, int askSize) {
     std::string orderbookData = "{\"type\":\"orderbook_update\",\"symbol\":\"" + symbol + 
                                "\",\"bestBid\":" + std::to_string(bestBid) + 
@@ -266,7 +543,13 @@ void SimpleServer::broadcast_order_status(const std::string& orderId, const std:
     broadcastMessage(statusData);
 }
 
-void SimpleServer::set_matching_engine_callback(std::function<std::string(OrderType, double, int, const std::string&, const std::string&)> submit_callback) {
+void SimpleServer::broadcast_flow_alert(const std::string& symbol, const FlowMetrics& metrics) {
+    std::string alertData = "{\"type\":\"flow_alert\",\"metrics\":" + flow_metrics_to_json(symbol, metrics) + "}";
+    
+    broadcastMessage(alertData);
+}
+
+void SimpleServer::set_matching_engine_callback(std::function<std::string(OrderType, double, int, const std::string&, uint32_t, const std::string&)> submit_callback) {
     submitCallback = submit_callback;
 }
 
@@ -274,15 +557,168 @@ void SimpleServer::set_cancel_callback(std::function<bool(const std::string&)> c
     cancelCallback = cancel_callback;
 }
 
+void SimpleServer::set_modify_callback(std::function<bool(const std::string&, double, int)> modify_callback) {
+    modifyCallback = modify_callback;
+}
+
+void SimpleServer::set_metrics_callback(MetricsCallback metrics_callback) {
+    metricsCallback = metrics_callback;
+}
+
+void SimpleServer::set_symbol_resolver(SymbolResolver symbol_resolver) {
+    symbolResolver = symbol_resolver;
+}
+
+void SimpleServer::set_session_capture(SessionCapture* session_capture) {
+    capture = session_capture;
+}
+
+void SimpleServer::set_kernel_timestamping(bool enabled) {
+#ifndef __linux__
+    if (enabled) {
+        std::cerr << "Kernel timestamping is only available on Linux" << std::endl;
+    }
+#endif
+    kernelTimestamping = enabled;
+}
+
 void SimpleServer::sendMessage(int clientSocket, const std::string& message) {
     std::string fullMessage = message + "\n";
+    ClientSession* session = handlingSession;
+    if (session && session->kernelTimestamps && session->socket == clientSocket) {
+        send_stamped(*session, fullMessage);
+        return;
+    }
     send(clientSocket, fullMessage.c_str(), fullMessage.length(), 0);
 }
 
-void SimpleServer::broadcastMessage(const std::string& message) {
+int SimpleServer::receive(ClientSession& session, char* buffer, size_t size) {
+#ifdef __linux__
+    if (session.kernelTimestamps) {
+        char control[256];
+        struct iovec chunk = {buffer, size};
+        struct msghdr message {};
+        message.msg_iov = &chunk;
+        message.msg_iovlen = 1;
+        message.msg_control = control;
+        message.msg_controllen = sizeof(control);
+        
+        int bytesReceived = recvmsg(session.socket, &message, 0);
+        session.userRxNs = now_ns();
+        session.kernelRxNs = (bytesReceived > 0) ? kernel_timestamp_ns(message) : 0;
+        if (session.kernelRxNs > 0) {
+            latency.socketQueue.record(session.userRxNs - session.kernelRxNs);
+        }
+        
+        // Transmit stamps that arrived after their send() was handled
+        collect_tx_timestamps(session);
+        return bytesReceived;
+    }
+#endif
+    int bytesReceived = recv(session.socket, buffer, size, 0);
+    session.userRxNs = now_ns();
+    return bytesReceived;
+}
+
+// A transmit timestamp is requested for this send only, so broadcasts written
+// to the same socket by other threads never reach the error queue; the stamp
+// that comes back names the send by the offset of its last byte
+void SimpleServer::send_stamped(ClientSession& session, const std::string& message) {
+#ifdef __linux__
+    char control[CMSG_SPACE(sizeof(uint32_t))] = {};
+    struct iovec chunk = {const_cast<char*>(message.data()), message.size()};
+    struct msghdr header {};
+    header.msg_iov = &chunk;
+    header.msg_iovlen = 1;
+    header.msg_control = control;
+    header.msg_controllen = sizeof(control);
+    
+    struct cmsghdr* request = CMSG_FIRSTHDR(&header);
+    request->cmsg_level = SOL_SOCKET;
+    request->cmsg_type = SO_TIMESTAMPING;
+    request->cmsg_len = CMSG_LEN(sizeof(uint32_t));
+    uint32_t flags = SOF_TIMESTAMPING_TX_SOFTWARE;
+    std::memcpy(CMSG_DATA(request), &flags, sizeof(flags));
+    
+    int64_t sendNs = now_ns();
+    {
+        std::lock_guard<std::mutex> lock(session.sendMutex);
+        ssize_t sent = sendmsg(session.socket, &header, 0);
+        if (sent > 0) {
+            session.bytesSent += sent;
+            if (session.pendingTx.size() >= MAX_PENDING_TX) {
+                session.pendingTx.pop_front();
+            }
+            session.pendingTx.push_back({session.kernelRxNs, session.userRxNs, sendNs,
+                                         static_cast<uint32_t>(session.bytesSent - 1)});
+        }
+    }
+    collect_tx_timestamps(session);
+#else
+    send(session.socket, message.c_str(), message.length(), 0);
+#endif
+}
+
+// Unstamped write to a timestamped session's socket, from any thread
+void SimpleServer::send_counted(ClientSession& session, const std::string& message) {
+    std::lock_guard<std::mutex> lock(session.sendMutex);
+    ssize_t sent = send(session.socket, message.c_str(), message.length(), 0);
+    if (sent > 0) {
+        session.bytesSent += sent;
+    }
+}
+
+void SimpleServer::collect_tx_timestamps(ClientSession& session) {
+#ifdef __linux__
+    while (!session.pendingTx.empty()) {
+        char control[512];
+        struct msghdr message {};
+        message.msg_control = control;
+        message.msg_controllen = sizeof(control);
+        if (recvmsg(session.socket, &message, MSG_ERRQUEUE | MSG_DONTWAIT) < 0) {
+            break; // Not transmitted yet; picked up after a later recv or send
+        }
+        
+        int64_t kernelTxNs = kernel_timestamp_ns(message);
+        uint32_t key;
+        if (kernelTxNs == 0 || !timestamp_key(message, key)) continue;
+        
+        // Sends before this one whose stamp never came (their last byte shared
+        // a segment with a later stamped send) are given up on
+        while (!session.pendingTx.empty() && static_cast<int32_t>(session.pendingTx.front().lastByte - key) < 0) {
+            session.pendingTx.pop_front();
+        }
+        if (session.pendingTx.empty() || session.pendingTx.front().lastByte != key) continue;
+        
+        PendingTxStamp stamp = session.pendingTx.front();
+        session.pendingTx.pop_front();
+        latency.engine.record(stamp.sendNs - stamp.userRxNs);
+        latency.transmit.record(kernelTxNs - stamp.sendNs);
+        if (stamp.kernelRxNs > 0) {
+            latency.wireToWire.record(kernelTxNs - stamp.kernelRxNs);
+        }
+    }
+#else
+    (void)session;
+#endif
+}
+
+void SimpleServer::broadcastMessage(const std::string& message, const ClientSession* stamped, int64_t matchedNs) {
     std::lock_guard<std::mutex> lock(clientMutex);
     for (int clientSocket : clientSockets) {
         try {
+            bool withTimestamps = stamped && stamped->socket == clientSocket;
+            auto session = timestampedSessions.find(clientSocket);
+            if (session != timestampedSessions.end() && session->second != handlingSession) {
+                // Counted so that session's transmit stamps still match by offset
+                send_counted(*session->second,
+                             (withTimestamps ? append_timestamps(message, *stamped, matchedNs) : message) + "\n");
+                continue;
+            }
+            if (withTimestamps) {
+                sendMessage(clientSocket, append_timestamps(message, *stamped, matchedNs));
+                continue;
+            }
             sendMessage(clientSocket, message);
         } catch (const std::exception& e) {
             std::cerr << "Error broadcasting message: " << e.what() << std::endl;
@@ -290,10 +726,58 @@ void SimpleServer::broadcastMessage(const std::string& message) {
     }
 }
 
+std::string SimpleServer::extract_field(const std::string& message, const std::string& key) {
+    size_t pos = message.find("\"" + key + "\"");
+    if (pos == std::string::npos) return "";
+    pos = message.find(':', pos + key.size() + 2);
+    if (pos == std::string::npos) return "";
+    
+    size_t end = message.find_first_of(",}", pos + 1);
+    std::string value = message.substr(pos + 1, end == std::string::npos ? std::string::npos : end - pos - 1);
+    value.erase(std::remove(value.begin(), value.end(), '"'), value.end());
+    value.erase(std::remove(value.begin(), value.end(), ' '), value.end());
+    return value;
+}
+
 std::string SimpleServer::createJsonResponse(const std::string& type, const std::string& data) {
     return "{\"type\":\"" + type + "\",\"message\":\"" + data + "\"}";
 }
 
+std::string SimpleServer::append_timestamps(const std::string& message, const ClientSession& session,
+                                            int64_t matchedNs) {
+    std::string stamped = message.substr(0, message.size() - 1);
+    stamped += ",\"ts\":[" + std::to_string(session.userRxNs) + ',' + std::to_string(session.sequencedNs) + ',' +
+               std::to_string(matchedNs) + ',' + std::to_string(now_ns()) + "]}";
+    return stamped;
+}
+
+void SimpleServer::send_response(ClientSession& session, const std::string& response) {
+    if (session.ackTimestamps) {
+        sendMessage(session.socket, append_timestamps(response, session, session.matchedNs));
+    } else {
+        sendMessage(session.socket, response);
+    }
+}
+
+std::string SimpleServer::flow_metrics_to_json(const std::string& symbol, const FlowMetrics& metrics) {
+    return "{\"symbol\":\"" + symbol +
+           "\",\"vpin\":" + std::to_string(metrics.vpin) +
+           ",\"orderFlowImbalance\":" + std::to_string(metrics.orderFlowImbalance) +
+           ",\"buckets\":" + std::to_string(metrics.buckets) +
+           ",\"totalVolume\":" + std::to_string(metrics.totalVolume) +
+           ",\"executions\":" + std::to_string(metrics.executions) +
+           ",\"toxic\":" + (metrics.toxic ? "true" : "false") + "}";
+}
+
+std::string SimpleServer::histogram_to_json(const LatencyHistogram& histogram) {
+    return "{\"count\":" + std::to_string(histogram.count()) +
+           ",\"meanNs\":" + std::to_string(static_cast<int64_t>(histogram.mean())) +
+           ",\"p50Ns\":" + std::to_string(histogram.percentile(0.50)) +
+           ",\"p99Ns\":" + std::to_string(histogram.percentile(0.99)) +
+           ",\"p999Ns\":" + std::to_string(histogram.percentile(0.999)) +
+           ",\"maxNs\":" + std::to_string(histogram.max()) + "}";
+}
+
 OrderType SimpleServer::string_to_order_type(const std::string& type) {
     if (type == "BUY") return BUY;
     if (type == "SELL") return SELL;
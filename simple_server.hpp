@@ -1,10 +1,12 @@
 #ifndef SIMPLE_SERVER_HPP
 #define SIMPLE_SERVER_HPP
 
+#include <atomic>
 #include <iostream>
 #include <thread>
 #include <mutex>
 #include <set>
+#include <unordered_map>
 #include <functional>
 #include <string>
 #include <sstream>
@@ -14,6 +16,20 @@
 #include <unistd.h>
 #include <fcntl.h>
 #include "order.hpp"
+#include "flowToxicity.hpp"
+#include "clientSession.hpp"
+#include "sessionCapture.hpp"
+#include "latencyHistogram.hpp"
+
+// Where gateway latency goes, per timestamped response (acks, and fills sent to
+// the session whose order caused them). Kernel times are SO_TIMESTAMPING
+// software stamps, so socket queuing and the send path are split from our own.
+struct GatewayLatency {
+    LatencyHistogram socketQueue;   // kernel receive -> recv() returns
+    LatencyHistogram engine;        // recv() returns -> response handed to send()
+    LatencyHistogram transmit;      // send() -> kernel transmit
+    LatencyHistogram wireToWire;    // kernel receive -> kernel transmit
+};
 
 class SimpleServer {
 public:
@@ -27,38 +43,87 @@ public:
 
     // Message broadcasting
     void broadcast_trade(const Trade& trade);
+    void broadcast_execution(const ExecutionReport& report);
     void broadcast_orderbook_update(const std::string& symbol, double bestBid, double bestAsk, int bidSize, int askSize);
     void broadcast_order_status(const std::string& orderId, const std::string& status, const std::string& message = "");
+    void broadcast_flow_alert(const std::string& symbol, const FlowMetrics& metrics);
 
     // Order handling
-    void handle_order_submission(const std::string& orderData, int clientSocket);
-    void handle_order_cancellation(const std::string& orderId, int clientSocket);
+    // Orders may carry a per-session "clOrdId"; cancels and modifies may reference
+    // either the engine's "orderId" or the session's own "clOrdId". After
+    // set_timestamps, a session's acks and fills end with
+    // "ts":[received, sequenced, matched, sent] in ns since the epoch (0 for a
+    // stage a rejected request never reached).
+    void handle_order_submission(const std::string& orderData, ClientSession& session);
+    void handle_order_cancellation(const std::string& request, ClientSession& session);
+    void handle_order_modification(const std::string& request, ClientSession& session);
+    void handle_metrics_request(const std::string& request, int clientSocket);
+    void handle_latency_request(int clientSocket);
+    void handle_timestamps_request(const std::string& request, ClientSession& session);
 
-    // Set matching engine callback
-    void set_matching_engine_callback(std::function<std::string(OrderType, double, int, const std::string&, const std::string&)> submit_callback);
+    // Set matching engine callback. Submits get the symbol and the ID the
+    // symbol resolver gave for it, resolved once per session and symbol
+    // (UINT32_MAX without a resolver).
+    void set_matching_engine_callback(std::function<std::string(OrderType, double, int, const std::string&, uint32_t, const std::string&)> submit_callback);
     void set_cancel_callback(std::function<bool(const std::string&)> cancel_callback);
+    void set_modify_callback(std::function<bool(const std::string&, double, int)> modify_callback);
+
+    // Flow metrics for one symbol, or every symbol when the symbol is empty
+    using MetricsCallback = std::function<std::vector<std::pair<std::string, FlowMetrics>>(const std::string& symbol)>;
+    void set_metrics_callback(MetricsCallback metrics_callback);
+    using SymbolResolver = std::function<uint32_t(const std::string& symbol)>;
+    void set_symbol_resolver(SymbolResolver symbol_resolver);
+
+    // Record every session's inbound bytes; set before run(), owned by the caller
+    void set_session_capture(SessionCapture* session_capture);
+
+    // Kernel receive/transmit timestamps on client sockets (Linux); set before run()
+    void set_kernel_timestamping(bool enabled);
+    const GatewayLatency& get_latency() const { return latency; }
 
 private:
     int serverSocket;
     std::set<int> clientSockets;
+    std::unordered_map<int, ClientSession*> timestampedSessions;   // by socket
     std::mutex clientMutex;
     std::thread serverThread;
     bool running;
+    std::atomic<uint64_t> nextSessionId;
+    SessionCapture* capture;
+    bool kernelTimestamping;
+    GatewayLatency latency;
 
     // Matching engine callbacks
-    std::function<std::string(OrderType, double, int, const std::string&, const std::string&)> submitCallback;
+    std::function<std::string(OrderType, double, int, const std::string&, uint32_t, const std::string&)> submitCallback;
     std::function<bool(const std::string&)> cancelCallback;
+    std::function<bool(const std::string&, double, int)> modifyCallback;
+    MetricsCallback metricsCallback;
+    SymbolResolver symbolResolver;
 
     // Server functions
     void serverWorker();
     void handleClient(int clientSocket);
+    void handleMessage(const std::string& message, ClientSession& session);
     void sendMessage(int clientSocket, const std::string& message);
-    void broadcastMessage(const std::string& message);
+    int receive(ClientSession& session, char* buffer, size_t size);
+    void send_stamped(ClientSession& session, const std::string& message);
+    void send_counted(ClientSession& session, const std::string& message);
+    void collect_tx_timestamps(ClientSession& session);
+    // The stamped session, if any, gets the message with its latency breakdown
+    void broadcastMessage(const std::string& message, const ClientSession* stamped = nullptr, int64_t matchedNs = 0);
     
     // Helper functions
     OrderType string_to_order_type(const std::string& type);
     std::string order_type_to_string(OrderType type);
+    std::string extract_field(const std::string& message, const std::string& key);
+    bool resolve_order_id(const std::string& request, const ClientSession& session,
+                          std::string& orderId, std::string& reference);
+    std::string reference_suffix(const std::string& request, const std::string& reference);
     std::string createJsonResponse(const std::string& type, const std::string& data);
+    std::string append_timestamps(const std::string& message, const ClientSession& session, int64_t matchedNs);
+    void send_response(ClientSession& session, const std::string& response);
+    std::string flow_metrics_to_json(const std::string& symbol, const FlowMetrics& metrics);
+    std::string histogram_to_json(const LatencyHistogram& histogram);
 };
 
 #endif // SIMPLE_SERVER_HPP
@@ -0,0 +1,105 @@
+// sor_sim.cpp
+// Backtest harness for SmartOrderRouter: random background flow on several
+// in-process venues and symbols, with parent orders routed against it.
+#include "venueRouter.hpp"
+#include <chrono>
+#include <iomanip>
+#include <iostream>
+#include <random>
+#include <string>
+#include <vector>
+
+int main(int argc, char* argv[]) {
+    int symbols = 100;
+    int64_t durationMs = 1000;
+    int parentsPerSymbol = 20;
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        if (arg == "--symbols" && i + 1 < argc) {
+            symbols = std::stoi(argv[++i]);
+        } else if (arg == "--duration-ms" && i + 1 < argc) {
+            durationMs = std::stoll(argv[++i]);
+        } else if (arg == "--parents" && i + 1 < argc) {
+            parentsPerSymbol = std::stoi(argv[++i]);
+        } else {
+            std::cerr << "Usage: " << argv[0] << " [--symbols N] [--duration-ms T] [--parents P]" << std::endl;
+            return 1;
+        }
+    }
+
+    VenueSet venues(42);
+    venues.add_venue({"FAST", 50000, 20000, 0.0020, 0.0030});
+    venues.add_venue({"CHEAP", 250000, 100000, -0.0010, 0.0015});
+    venues.add_venue({"DARKISH", 600000, 300000, 0.0000, 0.0010});
+    SmartOrderRouter router(venues);
+
+    std::mt19937_64 rng(7);
+    std::uniform_int_distribution<int> tickOffset(-20, 20);
+    std::uniform_int_distribution<int> size(1, 200);
+    std::uniform_int_distribution<int> side(0, 1);
+    std::uniform_int_distribution<size_t> venue(0, venues.venue_count() - 1);
+
+    std::vector<std::string> names;
+    for (int s = 0; s < symbols; ++s) {
+        names.push_back("SYM" + std::to_string(s));
+    }
+
+    // Background flow on random venues for every symbol, with parent orders spread
+    // evenly over the run. Flow is generated as the clock advances to keep the
+    // event queue short.
+    const int64_t durationNs = durationMs * 1000000;
+    const int64_t flowStepNs = 100000;
+    const int64_t parentStepNs = durationNs / (parentsPerSymbol + 1);
+    int64_t nextParentNs = parentStepNs;
+    size_t flowOrders = 0;
+    std::vector<uint64_t> parents;
+
+    auto wallStart = std::chrono::steady_clock::now();
+    for (int64_t t = 0; t < durationNs; t += flowStepNs) {
+        for (const auto& name : names) {
+            OrderType type = side(rng) ? BUY : SELL;
+            double price = 100.00 + tickOffset(rng) * 0.01 + (type == BUY ? -0.05 : 0.05);
+            venues.schedule_order(venue(rng), t, name, type, price, size(rng));
+            flowOrders++;
+        }
+        venues.run_until(t);
+
+        if (t >= nextParentNs) {
+            for (const auto& name : names) {
+                OrderType type = side(rng) ? BUY : SELL;
+                double limit = (type == BUY) ? 100.15 : 99.85;
+                parents.push_back(router.route(name, type, 500, limit, parents.size() % 4 == 0));
+            }
+            nextParentNs += parentStepNs;
+        }
+    }
+    venues.run_until(durationNs + 10000000);
+    double wallSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - wallStart).count();
+
+    int64_t requested = 0;
+    int64_t filled = 0;
+    double fees = 0.0;
+    int64_t latencySum = 0;
+    size_t done = 0;
+    for (uint64_t id : parents) {
+        const ParentOrder* parent = router.get_parent(id);
+        requested += parent->quantity;
+        filled += parent->filled;
+        fees += parent->fees;
+        if (parent->openChildren == 0) {
+            latencySum += parent->doneNs - parent->startNs;
+            done++;
+        }
+    }
+
+    std::cout << std::fixed << std::setprecision(2)
+              << "Venues: " << venues.venue_count() << ", symbols: " << symbols
+              << ", background orders: " << flowOrders << ", parents: " << parents.size() << "\n"
+              << "Fill rate: " << (requested > 0 ? 100.0 * filled / requested : 0.0) << "%"
+              << ", fees: " << fees
+              << ", mean completion: " << (done > 0 ? latencySum / double(done) / 1000.0 : 0.0) << " us"
+              << " (" << done << " complete)\n"
+              << "Simulated " << durationMs << " ms in " << wallSeconds << " s ("
+              << (flowOrders / wallSeconds / 1e6) << "M orders/s on one core)" << std::endl;
+    return 0;
+}
@@ -0,0 +1,340 @@
+// spreadMatcher.cpp
+#include "spreadMatcher.hpp"
+#include <algorithm>
+
+namespace {
+
+// Implied prices are sums and differences of leg prices
+constexpr double PRICE_EPSILON = 1e-9;
+
+template <typename Levels>
+const std::shared_ptr<Order>& front_order(const Levels& levels) {
+    return levels.begin()->second.front();
+}
+
+// First order in line on one side of a book, nullptr if the side is empty
+std::shared_ptr<Order> best_order(const OrderBook& book, OrderType side) {
+    if (side == BUY) return book.buyOrders.empty() ? nullptr : front_order(book.buyOrders);
+    return book.sellOrders.empty() ? nullptr : front_order(book.sellOrders);
+}
+
+} // namespace
+
+MatchingEngine& SpreadMatcher::outright(const std::string& symbol) {
+    return *leg(symbol).engine;
+}
+
+SpreadMatcher::Leg& SpreadMatcher::leg(const std::string& symbol) {
+    Leg& entry = legs[symbol];
+    if (!entry.engine) {
+        entry.engine.reset(new MatchingEngine());
+        entry.engine->set_book_update_callback([this, &entry](const std::string&, const OrderBook&) {
+            on_leg_update(entry);
+        });
+    }
+    return entry;
+}
+
+SpreadMatcher::Spread* SpreadMatcher::find_spread(const std::string& spread) const {
+    auto it = spreadIndex.find(spread);
+    return (it != spreadIndex.end()) ? spreads[it->second].get() : nullptr;
+}
+
+bool SpreadMatcher::define_spread(const std::string& spread, const std::string& nearLeg, const std::string& farLeg) {
+    if (spreadIndex.count(spread) || nearLeg == farLeg) return false;
+
+    std::unique_ptr<Spread> entry(new Spread());
+    entry->name = spread;
+    entry->nearSymbol = nearLeg;
+    entry->farSymbol = farLeg;
+    entry->nearLeg = &leg(nearLeg);
+    entry->farLeg = &leg(farLeg);
+
+    size_t index = spreads.size();
+    entry->nearLeg->spreads.push_back(index);
+    entry->farLeg->spreads.push_back(index);
+    spreadIndex[spread] = index;
+    spreads.push_back(std::move(entry));
+    return true;
+}
+
+void SpreadMatcher::on_leg_update(Leg& entry) {
+    const OrderBook& book = entry.engine->get_order_book();
+    LegTop& top = entry.top;
+    if (top.bestBid == book.bestBid && top.bidSize == book.bidSize &&
+        top.bestAsk == book.bestAsk && top.askSize == book.askSize) {
+        return;
+    }
+
+    top = {book.bestBid, book.bidSize, book.bestAsk, book.askSize};
+    for (size_t index : entry.spreads) {
+        spreads[index]->dirty = true;
+    }
+}
+
+std::string SpreadMatcher::submit_outright(const std::string& symbol, OrderType type, double price, int quantity,
+                                           const std::string& clientId) {
+    Leg& entry = leg(symbol);
+    auto order = entry.engine->prepare_order(type, price, quantity, symbol, clientId);
+    if (!order) return "";
+
+    // Implied-in prices better than the outright touch are taken first
+    while (order->getRemainingQuantity() > 0) {
+        Spread* spread = better_implied_in(entry, *order);
+        if (!spread) break;
+
+        // Buying the near leg or selling the far leg sells the spread
+        bool nearLeg = spread->nearLeg == &entry;
+        OrderType spreadSide = ((type == BUY) == nearLeg) ? SELL : BUY;
+        if (!execute_implied(*spread, best_order(spread->book, spreadSide),
+                             nearLeg ? NEAR_AGGRESSOR : FAR_AGGRESSOR, order)) {
+            break;
+        }
+    }
+    entry.engine->submit_prepared(order);
+
+    // Implied out: only spreads with resting orders whose leg tops just moved
+    for (size_t index : entry.spreads) {
+        Spread& spread = *spreads[index];
+        if (spread.dirty && !(spread.book.buyOrders.empty() && spread.book.sellOrders.empty())) {
+            uncross(spread, (spread.nearLeg == &entry) ? NEAR_AGGRESSOR : FAR_AGGRESSOR);
+        }
+    }
+    return order->orderId;
+}
+
+// The spread with the best implied-in price for order's leg that the order
+// crosses and that is strictly better than the outright touch, if any
+SpreadMatcher::Spread* SpreadMatcher::better_implied_in(Leg& entry, const Order& order) {
+    const OrderBook& outrightBook = entry.engine->get_order_book();
+    bool buy = order.type == BUY;
+    bool hasTouch = buy ? !outrightBook.sellOrders.empty() : !outrightBook.buyOrders.empty();
+    double touch = buy ? (hasTouch ? outrightBook.sellOrders.begin()->first : 0.0)
+                       : (hasTouch ? outrightBook.buyOrders.begin()->first : 0.0);
+
+    Spread* best = nullptr;
+    double bestPrice = 0.0;
+    for (size_t index : entry.spreads) {
+        Spread& spread = *spreads[index];
+        if (spread.book.buyOrders.empty() && spread.book.sellOrders.empty()) continue;
+        if (spread.dirty) recompute(spread);
+
+        const ImpliedQuote& quote = (spread.nearLeg == &entry) ? spread.implied.nearLeg : spread.implied.farLeg;
+        double impliedPrice = buy ? quote.askPrice : quote.bidPrice;
+        if ((buy ? quote.askQuantity : quote.bidQuantity) <= 0) continue;
+
+        bool usable = buy ? (impliedPrice <= order.price + PRICE_EPSILON &&
+                             (!hasTouch || impliedPrice < touch - PRICE_EPSILON) &&
+                             (!best || impliedPrice < bestPrice - PRICE_EPSILON))
+                          : (impliedPrice >= order.price - PRICE_EPSILON &&
+                             (!hasTouch || impliedPrice > touch + PRICE_EPSILON) &&
+                             (!best || impliedPrice > bestPrice + PRICE_EPSILON));
+        if (usable) {
+            best = &spread;
+            bestPrice = impliedPrice;
+        }
+    }
+    return best;
+}
+
+bool SpreadMatcher::cancel_outright(const std::string& symbol, const std::string& orderId) {
+    auto it = legs.find(symbol);
+    return it != legs.end() && it->second.engine->cancel_order(orderId);
+}
+
+std::string SpreadMatcher::submit_spread(const std::string& name, OrderType type, double price, int quantity,
+                                         const std::string& clientId) {
+    Spread* spread = find_spread(name);
+    if (!spread || quantity <= 0) return "";
+
+    std::string orderId = "X" + std::to_string(++spreadOrderCounter);
+    auto order = std::make_shared<Order>(orderId, type, price, quantity, name, clientId);
+    OrderBook& book = spread->book;
+
+    // Take the better of the direct spread book and the implied price from the legs;
+    // the direct book wins ties
+    while (order->getRemainingQuantity() > 0) {
+        if (spread->dirty) recompute(*spread);
+
+        bool directCrosses = false;
+        bool impliedCrosses = false;
+        double directPrice = 0.0;
+        double impliedPrice = 0.0;
+        if (type == BUY) {
+            if (!book.sellOrders.empty()) {
+                directPrice = book.sellOrders.begin()->first;
+                directCrosses = directPrice <= price + PRICE_EPSILON;
+            }
+            if (spread->implied.spread.askQuantity > 0) {
+                impliedPrice = spread->implied.spread.askPrice;
+                impliedCrosses = impliedPrice <= price + PRICE_EPSILON;
+            }
+        } else {
+            if (!book.buyOrders.empty()) {
+                directPrice = book.buyOrders.begin()->first;
+                directCrosses = directPrice >= price - PRICE_EPSILON;
+            }
+            if (spread->implied.spread.bidQuantity > 0) {
+                impliedPrice = spread->implied.spread.bidPrice;
+                impliedCrosses = impliedPrice >= price - PRICE_EPSILON;
+            }
+        }
+
+        bool useDirect = directCrosses &&
+            (!impliedCrosses || (type == BUY ? directPrice <= impliedPrice + PRICE_EPSILON
+                                             : directPrice >= impliedPrice - PRICE_EPSILON));
+        if (useDirect) {
+            auto resting = (type == BUY) ? front_order(book.sellOrders) : front_order(book.buyOrders);
+            int fillQuantity = std::min(order->getRemainingQuantity(), resting->getRemainingQuantity());
+            std::string restingId = resting->orderId;
+            if (type == BUY) {
+                book.execute_trade(order, resting, fillQuantity, directPrice);
+            } else {
+                book.execute_trade(resting, order, fillQuantity, directPrice);
+            }
+            spread->dirty = true;
+
+            if (onFill) {
+                onFill({name, orderId, type, directPrice, fillQuantity, false, restingId, "", 0.0, "", 0.0});
+            }
+        } else if (!impliedCrosses || !execute_implied(*spread, order, SPREAD_AGGRESSOR)) {
+            break;
+        }
+    }
+
+    if (order->getRemainingQuantity() > 0) {
+        book.add_order(order);
+        spread->dirty = true;
+    }
+    return orderId;
+}
+
+bool SpreadMatcher::cancel_spread(const std::string& name, const std::string& orderId) {
+    Spread* spread = find_spread(name);
+    if (!spread || !spread->book.cancel_order(orderId)) return false;
+
+    spread->dirty = true;
+    return true;
+}
+
+bool SpreadMatcher::get_implied(const std::string& name, ImpliedPrices& out) {
+    Spread* spread = find_spread(name);
+    if (!spread) return false;
+
+    if (spread->dirty) recompute(*spread);
+    out = spread->implied;
+    return true;
+}
+
+const OrderBook* SpreadMatcher::get_spread_book(const std::string& name) const {
+    Spread* spread = find_spread(name);
+    return spread ? &spread->book : nullptr;
+}
+
+void SpreadMatcher::recompute(Spread& spread) {
+    const OrderBook& nearBook = spread.nearLeg->engine->get_order_book();
+    const OrderBook& farBook = spread.farLeg->engine->get_order_book();
+    const OrderBook& spreadBook = spread.book;
+
+    bool nearBid = !nearBook.buyOrders.empty();
+    bool nearAsk = !nearBook.sellOrders.empty();
+    bool farBid = !farBook.buyOrders.empty();
+    bool farAsk = !farBook.sellOrders.empty();
+    bool spreadBid = !spreadBook.buyOrders.empty();
+    bool spreadAsk = !spreadBook.sellOrders.empty();
+
+    auto quote = [](bool bid, double bidPrice, int bidA, int bidB, bool ask, double askPrice, int askA, int askB) {
+        ImpliedQuote result;
+        if (bid) {
+            result.bidPrice = bidPrice;
+            result.bidQuantity = std::min(bidA, bidB);
+        }
+        if (ask) {
+            result.askPrice = askPrice;
+            result.askQuantity = std::min(askA, askB);
+        }
+        return result;
+    };
+
+    // Implied out: buy near and sell far, or the reverse
+    spread.implied.spread = quote(nearBid && farAsk, nearBook.bestBid - farBook.bestAsk, nearBook.bidSize, farBook.askSize,
+                                  nearAsk && farBid, nearBook.bestAsk - farBook.bestBid, nearBook.askSize, farBook.bidSize);
+
+    // Implied in, near = spread + far and far = near - spread
+    spread.implied.nearLeg = quote(spreadBid && farBid, spreadBook.bestBid + farBook.bestBid, spreadBook.bidSize, farBook.bidSize,
+                                   spreadAsk && farAsk, spreadBook.bestAsk + farBook.bestAsk, spreadBook.askSize, farBook.askSize);
+    spread.implied.farLeg = quote(nearBid && spreadAsk, nearBook.bestBid - spreadBook.bestAsk, nearBook.bidSize, spreadBook.askSize,
+                                  nearAsk && spreadBid, nearBook.bestAsk - spreadBook.bestBid, nearBook.askSize, spreadBook.bidSize);
+    spread.dirty = false;
+}
+
+void SpreadMatcher::uncross(Spread& spread, Aggressor aggressor) {
+    // Every implied-in cross is a resting spread order crossing the implied-out price
+    while (true) {
+        if (spread.dirty) recompute(spread);
+
+        const OrderBook& book = spread.book;
+        const ImpliedQuote& implied = spread.implied.spread;
+        std::shared_ptr<Order> resting;
+        if (!book.buyOrders.empty() && implied.askQuantity > 0 &&
+            book.buyOrders.begin()->first >= implied.askPrice - PRICE_EPSILON) {
+            resting = front_order(book.buyOrders);
+        } else if (!book.sellOrders.empty() && implied.bidQuantity > 0 &&
+                   book.sellOrders.begin()->first <= implied.bidPrice + PRICE_EPSILON) {
+            resting = front_order(book.sellOrders);
+        }
+        if (!resting || !execute_implied(spread, resting, aggressor)) break;
+    }
+}
+
+// legOrder, when given, is an incoming outright order on the aggressor leg; it
+// stands in for that leg's resting order and is filled directly
+bool SpreadMatcher::execute_implied(Spread& spread, const std::shared_ptr<Order>& spreadOrder, Aggressor aggressor,
+                                    const std::shared_ptr<Order>& legOrder) {
+    if (!spreadOrder) return false;
+
+    // Buying the spread lifts the near ask and hits the far bid
+    bool buySpread = spreadOrder->type == BUY;
+    std::shared_ptr<Order> nearOrder = (legOrder && aggressor == NEAR_AGGRESSOR)
+        ? legOrder : best_order(spread.nearLeg->engine->get_order_book(), buySpread ? SELL : BUY);
+    std::shared_ptr<Order> farOrder = (legOrder && aggressor == FAR_AGGRESSOR)
+        ? legOrder : best_order(spread.farLeg->engine->get_order_book(), buySpread ? BUY : SELL);
+    if (!nearOrder || !farOrder) return false;
+
+    int quantity = std::min({spreadOrder->getRemainingQuantity(), nearOrder->getRemainingQuantity(),
+                             farOrder->getRemainingQuantity()});
+
+    // Resting orders keep their prices; the aggressor gets the implied price
+    double spreadPrice = spreadOrder->price;
+    double nearPrice = nearOrder->price;
+    double farPrice = farOrder->price;
+    switch (aggressor) {
+    case SPREAD_AGGRESSOR: spreadPrice = nearPrice - farPrice; break;
+    case NEAR_AGGRESSOR: nearPrice = spreadPrice + farPrice; break;
+    case FAR_AGGRESSOR: farPrice = nearPrice - spreadPrice; break;
+    }
+
+    // All three fills are applied together before anything else can run
+    if (nearOrder == legOrder) {
+        nearOrder->fill(quantity);
+    } else {
+        spread.nearLeg->engine->fill_resting_order(nearOrder->orderId, quantity);
+    }
+    if (farOrder == legOrder) {
+        farOrder->fill(quantity);
+    } else {
+        spread.farLeg->engine->fill_resting_order(farOrder->orderId, quantity);
+    }
+    if (spread.book.get_order(spreadOrder->orderId) == spreadOrder) {
+        spread.book.fill_resting(spreadOrder, quantity);
+    } else {
+        spreadOrder->fill(quantity);
+    }
+    spread.dirty = true;
+
+    if (onFill) {
+        onFill({spread.name, spreadOrder->orderId, spreadOrder->type, spreadPrice, quantity, true, "",
+                nearOrder->orderId, nearPrice, farOrder->orderId, farPrice});
+    }
+    return true;
+}
@@ -0,0 +1,118 @@
+// spreadMatcher.hpp
+#ifndef SPREADMATCHER_HPP
+#define SPREADMATCHER_HPP
+
+#include "matchingEngine.hpp"
+#include <functional>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+// Best implied price and size on each side; quantity 0 means no implied price
+struct ImpliedQuote {
+    double bidPrice = 0.0;
+    int bidQuantity = 0;
+    double askPrice = 0.0;
+    int askQuantity = 0;
+};
+
+// Implied prices of one calendar spread (near leg minus far leg)
+struct ImpliedPrices {
+    ImpliedQuote spread;    // implied out: from the two outright books
+    ImpliedQuote nearLeg;   // implied in: from the spread book and the far leg
+    ImpliedQuote farLeg;    // implied in: from the spread book and the near leg
+};
+
+// One spread trade. Implied trades fill the spread order and both legs together,
+// with nearPrice - farPrice == spreadPrice; direct trades are spread against
+// spread and leave the leg fields empty.
+struct SpreadFill {
+    std::string spread;
+    std::string spreadOrderId;
+    OrderType spreadSide;           // side of spreadOrderId
+    double spreadPrice;
+    int quantity;
+    bool implied;
+    std::string contraOrderId;      // direct trades only
+    std::string nearOrderId;
+    double nearPrice;
+    std::string farOrderId;
+    double farPrice;
+};
+
+// Outright books plus calendar spread books with implied matching between them.
+// Buying the spread buys the near leg and sells the far leg.
+//
+// Plain outright orders go straight to their MatchingEngine. Implied prices are
+// cached per spread and only marked dirty when a leg's top of book (best price
+// or size) changes; they are recomputed, and crosses against the outright books
+// resolved, only for spreads that have resting orders. An outright order first
+// takes implied-in prices that are better than its own book's touch, then
+// matches the outright book (which wins ties), and what rests may then trade
+// against resting spread orders as implied out. Single-threaded, like
+// MatchingEngine.
+class SpreadMatcher {
+public:
+    using FillCallback = std::function<void(const SpreadFill&)>;
+
+    // Outright book, created on first use
+    MatchingEngine& outright(const std::string& symbol);
+
+    bool define_spread(const std::string& spread, const std::string& nearLeg, const std::string& farLeg);
+
+    std::string submit_outright(const std::string& symbol, OrderType type, double price, int quantity,
+                                const std::string& clientId = "DEFAULT");
+    bool cancel_outright(const std::string& symbol, const std::string& orderId);
+
+    // Spread prices may be zero or negative
+    std::string submit_spread(const std::string& spread, OrderType type, double price, int quantity,
+                              const std::string& clientId = "DEFAULT");
+    bool cancel_spread(const std::string& spread, const std::string& orderId);
+
+    bool get_implied(const std::string& spread, ImpliedPrices& out);
+    const OrderBook* get_spread_book(const std::string& spread) const;
+
+    void set_fill_callback(FillCallback callback) { onFill = std::move(callback); }
+
+private:
+    struct LegTop {
+        double bestBid = 0.0;
+        int bidSize = 0;
+        double bestAsk = 0.0;
+        int askSize = 0;
+    };
+    struct Leg {
+        std::unique_ptr<MatchingEngine> engine;
+        LegTop top;
+        std::vector<size_t> spreads;
+    };
+    struct Spread {
+        std::string name;
+        std::string nearSymbol;
+        std::string farSymbol;
+        Leg* nearLeg;
+        Leg* farLeg;
+        OrderBook book;
+        ImpliedPrices implied;
+        bool dirty = true;
+    };
+    enum Aggressor { SPREAD_AGGRESSOR, NEAR_AGGRESSOR, FAR_AGGRESSOR };
+
+    std::unordered_map<std::string, Leg> legs;
+    std::vector<std::unique_ptr<Spread>> spreads;
+    std::unordered_map<std::string, size_t> spreadIndex;
+    FillCallback onFill;
+    uint64_t spreadOrderCounter = 0;
+
+    Leg& leg(const std::string& symbol);
+    Spread* find_spread(const std::string& spread) const;
+    void on_leg_update(Leg& leg);
+    void recompute(Spread& spread);
+    Spread* better_implied_in(Leg& leg, const Order& order);
+    void uncross(Spread& spread, Aggressor aggressor);
+    bool execute_implied(Spread& spread, const std::shared_ptr<Order>& spreadOrder, Aggressor aggressor,
+                         const std::shared_ptr<Order>& legOrder = nullptr);
+};
+
+#endif
@@ -0,0 +1,458 @@
+// tradeTape.cpp
+#include "tradeTape.hpp"
+#include "varint.hpp"
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <filesystem>
+#include <iostream>
+
+namespace {
+
+constexpr char TAPE_MAGIC[8] = {'L', 'O', 'B', 'T', 'A', 'P', 'E', '1'};
+constexpr uint32_t BLOCK_MAGIC = 0x4b4c4254; // "TBLK"
+
+struct TapeFileHeader {
+    char magic[8];
+    double tickSize;
+};
+
+struct TapeBlockHeader {
+    uint32_t magic;
+    uint32_t count;
+    int64_t firstTimestampNs;
+    int64_t firstPriceTicks;
+    uint32_t timestampBytes;
+    uint32_t priceBytes;
+    uint32_t quantityBytes;
+    uint32_t sideBytes;
+    uint32_t checksum;
+    uint32_t reserved;
+};
+
+// Returns the position after the last decoded varint, or nullptr on overrun
+const uint8_t* get_varints(const uint8_t* in, const uint8_t* end, size_t count, uint64_t* out) {
+    for (size_t i = 0; i < count; ++i) {
+        in = get_varint(in, end, out[i]);
+        if (!in) return nullptr;
+    }
+    return in;
+}
+
+// Branch-free so the compiler can vectorize it
+void unzigzag(const uint64_t* in, int64_t* out, size_t count) {
+    for (size_t i = 0; i < count; ++i) {
+        out[i] = ::unzigzag(in[i]);
+    }
+}
+
+int64_t to_ns(std::chrono::system_clock::time_point tp) {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(tp.time_since_epoch()).count();
+}
+
+int64_t steady_ns() {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+} // namespace
+
+void TapeColumns::reserve(size_t n) {
+    timestampNs.reserve(n);
+    priceTicks.reserve(n);
+    quantity.reserve(n);
+    aggressorSide.reserve(n);
+}
+
+void TapeColumns::clear() {
+    timestampNs.clear();
+    priceTicks.clear();
+    quantity.clear();
+    aggressorSide.clear();
+}
+
+TradeTapeWriter::TradeTapeWriter(const std::string& dir, double tickSize, const InstrumentMaster* master)
+    : directory(dir), defaultTickSize(tickSize), instruments(master), oldestOpenNs(0), flushRequested(false),
+      running(false), tradesWritten(0), bytesWritten(0) {
+}
+
+TradeTapeWriter::~TradeTapeWriter() {
+    stop();
+}
+
+bool TradeTapeWriter::start() {
+    if (running) return true;
+
+    std::error_code ec;
+    std::filesystem::create_directories(directory, ec);
+    if (ec) {
+        std::cerr << "Error: Could not create trade tape directory " << directory << ": " << ec.message() << std::endl;
+        return false;
+    }
+
+    running = true;
+    writerThread = std::thread(&TradeTapeWriter::writer_worker, this);
+    return true;
+}
+
+void TradeTapeWriter::stop() {
+    if (!running) return;
+
+    flush();
+    {
+        std::lock_guard<std::mutex> lock(queueMutex);
+        running = false;
+    }
+    queueCondition.notify_one();
+    if (writerThread.joinable()) {
+        writerThread.join();
+    }
+    files.clear();
+}
+
+void TradeTapeWriter::record(const ExecutionReport& report) {
+    if (flushRequested.load(std::memory_order_relaxed)) {
+        flush_aged();
+    }
+
+    int64_t timestampNs = to_ns(report.timestamp);
+    for (const auto& fill : report.fills) {
+        append(report.symbol, timestampNs, fill.price, fill.quantity, report.side);
+    }
+}
+
+void TradeTapeWriter::append(const std::string& symbol, int64_t timestampNs, double price, int quantity,
+                             OrderType aggressorSide) {
+    SymbolBuffer& buffer = buffer_for(symbol);
+    TapeColumns& columns = buffer.columns;
+
+    if (columns.size() == 0) {
+        buffer.startedNs = steady_ns();
+        if (oldestOpenNs.load(std::memory_order_relaxed) == 0) {
+            oldestOpenNs.store(buffer.startedNs, std::memory_order_relaxed);
+        }
+    }
+    columns.timestampNs.push_back(timestampNs);
+    columns.priceTicks.push_back(std::llround(price / buffer.tickSize));
+    columns.quantity.push_back(quantity);
+    columns.aggressorSide.push_back(static_cast<uint8_t>(aggressorSide));
+
+    if (columns.size() >= BLOCK_TRADES) {
+        submit_block(symbol, buffer);
+    }
+}
+
+void TradeTapeWriter::flush() {
+    for (auto& entry : buffers) {
+        if (entry.second.columns.size() > 0) {
+            submit_block(entry.first, entry.second);
+        }
+    }
+    oldestOpenNs.store(0, std::memory_order_relaxed);
+}
+
+// Quiet symbols still reach disk within a bounded delay
+void TradeTapeWriter::flush_aged() {
+    flushRequested.store(false, std::memory_order_relaxed);
+
+    int64_t now = steady_ns();
+    int64_t oldest = 0;
+    for (auto& entry : buffers) {
+        SymbolBuffer& buffer = entry.second;
+        if (buffer.columns.size() == 0) continue;
+        if (now - buffer.startedNs >= MAX_BLOCK_AGE_NS) {
+            submit_block(entry.first, buffer);
+        } else if (oldest == 0 || buffer.startedNs < oldest) {
+            oldest = buffer.startedNs;
+        }
+    }
+    oldestOpenNs.store(oldest, std::memory_order_relaxed);
+}
+
+TradeTapeWriter::SymbolBuffer& TradeTapeWriter::buffer_for(const std::string& symbol) {
+    auto it = buffers.find(symbol);
+    if (it != buffers.end()) return it->second;
+
+    SymbolBuffer buffer;
+    buffer.tickSize = defaultTickSize;
+    uint32_t symbolId = instruments ? instruments->find(symbol) : InstrumentMaster::INVALID_SYMBOL_ID;
+    if (symbolId != InstrumentMaster::INVALID_SYMBOL_ID) {
+        // Banded instruments are stored on the grid of their finest tick
+        const Instrument& instrument = instruments->get(symbolId);
+        int64_t finest = instrument.tickBands[0].tickSize;
+        for (int i = 1; i < instrument.tickBandCount; ++i) {
+            finest = std::min(finest, instrument.tickBands[i].tickSize);
+        }
+        buffer.tickSize = InstrumentMaster::from_price_units(finest);
+    }
+    buffer.columns.reserve(BLOCK_TRADES);
+    return buffers.emplace(symbol, std::move(buffer)).first->second;
+}
+
+void TradeTapeWriter::submit_block(const std::string& symbol, SymbolBuffer& buffer) {
+    PendingBlock block{symbol, buffer.tickSize, std::move(buffer.columns)};
+    buffer.columns = TapeColumns();
+    buffer.columns.reserve(BLOCK_TRADES);
+
+    {
+        std::lock_guard<std::mutex> lock(queueMutex);
+        pending.push(std::move(block));
+    }
+    queueCondition.notify_one();
+}
+
+void TradeTapeWriter::writer_worker() {
+    std::unique_lock<std::mutex> lock(queueMutex);
+    auto nextSweep = std::chrono::steady_clock::now() + std::chrono::nanoseconds(MAX_BLOCK_AGE_NS / 4);
+    while (true) {
+        queueCondition.wait_until(lock, nextSweep, [this] { return !pending.empty() || !running; });
+        if (pending.empty() && !running) break;
+
+        // Only a flag: the buffers belong to the matching thread
+        if (std::chrono::steady_clock::now() >= nextSweep) {
+            int64_t oldest = oldestOpenNs.load(std::memory_order_relaxed);
+            if (oldest != 0 && steady_ns() - oldest >= MAX_BLOCK_AGE_NS) {
+                flushRequested.store(true, std::memory_order_relaxed);
+            }
+            nextSweep = std::chrono::steady_clock::now() + std::chrono::nanoseconds(MAX_BLOCK_AGE_NS / 4);
+            if (pending.empty()) continue;
+        }
+
+        PendingBlock block = std::move(pending.front());
+        pending.pop();
+        lock.unlock();
+
+        write_block(block);
+
+        lock.lock();
+    }
+}
+
+TradeTapeWriter::TapeFile* TradeTapeWriter::open_tape(const std::string& symbol, double tickSize) {
+    auto it = files.find(symbol);
+    if (it != files.end()) return &it->second;
+
+    std::string dataPath = directory + "/" + symbol + ".tape";
+    std::string indexPath = directory + "/" + symbol + ".tidx";
+
+    // Existing tapes are appended to, provided they use the same price grid
+    std::error_code ec;
+    uint64_t existingSize = std::filesystem::exists(dataPath, ec) ? std::filesystem::file_size(dataPath, ec) : 0;
+    if (existingSize >= sizeof(TapeFileHeader)) {
+        std::ifstream existing(dataPath, std::ios::binary);
+        TapeFileHeader header;
+        existing.read(reinterpret_cast<char*>(&header), sizeof(header));
+        if (std::memcmp(header.magic, TAPE_MAGIC, sizeof(TAPE_MAGIC)) != 0 || header.tickSize != tickSize) {
+            std::cerr << "Error: " << dataPath << " is not a compatible trade tape" << std::endl;
+            return nullptr;
+        }
+    }
+
+    TapeFile tape;
+    tape.data.open(dataPath, std::ios::binary | std::ios::app);
+    tape.index.open(indexPath, std::ios::binary | std::ios::app);
+    if (!tape.data.is_open() || !tape.index.is_open()) {
+        std::cerr << "Error: Could not open trade tape " << dataPath << std::endl;
+        return nullptr;
+    }
+
+    if (existingSize < sizeof(TapeFileHeader)) {
+        TapeFileHeader header;
+        std::memcpy(header.magic, TAPE_MAGIC, sizeof(TAPE_MAGIC));
+        header.tickSize = tickSize;
+        tape.data.write(reinterpret_cast<const char*>(&header), sizeof(header));
+        existingSize = sizeof(header);
+    }
+    tape.offset = existingSize;
+
+    return &files.emplace(symbol, std::move(tape)).first->second;
+}
+
+void TradeTapeWriter::write_block(const PendingBlock& block) {
+    const TapeColumns& columns = block.columns;
+    size_t count = columns.size();
+    if (count == 0) return;
+
+    TapeFile* tape = open_tape(block.symbol, block.tickSize);
+    if (!tape) return;
+
+    std::vector<uint8_t>& out = encodeBuffer;
+    out.clear();
+    out.resize(sizeof(TapeBlockHeader));
+
+    TapeBlockHeader header{};
+    header.magic = BLOCK_MAGIC;
+    header.count = static_cast<uint32_t>(count);
+    header.firstTimestampNs = columns.timestampNs[0];
+    header.firstPriceTicks = columns.priceTicks[0];
+
+    size_t mark = out.size();
+    int64_t previousDelta = 0;
+    for (size_t i = 1; i < count; ++i) {
+        int64_t delta = columns.timestampNs[i] - columns.timestampNs[i - 1];
+        put_varint(out, zigzag(delta - previousDelta));
+        previousDelta = delta;
+    }
+    header.timestampBytes = static_cast<uint32_t>(out.size() - mark);
+
+    mark = out.size();
+    for (size_t i = 1; i < count; ++i) {
+        put_varint(out, zigzag(columns.priceTicks[i] - columns.priceTicks[i - 1]));
+    }
+    header.priceBytes = static_cast<uint32_t>(out.size() - mark);
+
+    mark = out.size();
+    for (size_t i = 0; i < count; ++i) {
+        put_varint(out, static_cast<uint32_t>(columns.quantity[i]));
+    }
+    header.quantityBytes = static_cast<uint32_t>(out.size() - mark);
+
+    mark = out.size();
+    out.resize(mark + (count + 7) / 8, 0);
+    for (size_t i = 0; i < count; ++i) {
+        out[mark + i / 8] |= static_cast<uint8_t>((columns.aggressorSide[i] & 1) << (i % 8));
+    }
+    header.sideBytes = static_cast<uint32_t>(out.size() - mark);
+
+    header.checksum = checksum(out.data() + sizeof(header), out.size() - sizeof(header));
+    std::memcpy(out.data(), &header, sizeof(header));
+
+    TapeBlockInfo info;
+    info.offset = tape->offset;
+    info.count = header.count;
+    info.size = static_cast<uint32_t>(out.size());
+    info.firstTimestampNs = columns.timestampNs.front();
+    info.lastTimestampNs = columns.timestampNs.back();
+
+    tape->data.write(reinterpret_cast<const char*>(out.data()), out.size());
+    tape->data.flush();
+    tape->index.write(reinterpret_cast<const char*>(&info), sizeof(info));
+    tape->index.flush();
+    tape->offset += out.size();
+
+    tradesWritten += count;
+    bytesWritten += out.size();
+}
+
+bool TradeTapeReader::open(const std::string& directory, const std::string& symbol) {
+    std::string dataPath = directory + "/" + symbol + ".tape";
+    std::string indexPath = directory + "/" + symbol + ".tidx";
+
+    data.open(dataPath, std::ios::binary);
+    std::ifstream index(indexPath, std::ios::binary);
+    if (!data.is_open() || !index.is_open()) {
+        std::cerr << "Error: Could not open trade tape " << dataPath << std::endl;
+        return false;
+    }
+
+    TapeFileHeader header;
+    if (!data.read(reinterpret_cast<char*>(&header), sizeof(header)) ||
+        std::memcmp(header.magic, TAPE_MAGIC, sizeof(TAPE_MAGIC)) != 0) {
+        std::cerr << "Error: " << dataPath << " is not a trade tape" << std::endl;
+        return false;
+    }
+    tickSize = header.tickSize;
+
+    TapeBlockInfo info;
+    while (index.read(reinterpret_cast<char*>(&info), sizeof(info))) {
+        blocks.push_back(info);
+    }
+    return true;
+}
+
+bool TradeTapeReader::read_block(size_t block, TapeColumns& out) {
+    if (block >= blocks.size()) return false;
+    const TapeBlockInfo& info = blocks[block];
+
+    blockBuffer.resize(info.size);
+    data.clear();
+    data.seekg(static_cast<std::streamoff>(info.offset));
+    if (!data.read(reinterpret_cast<char*>(blockBuffer.data()), info.size)) return false;
+
+    TapeBlockHeader header;
+    std::memcpy(&header, blockBuffer.data(), sizeof(header));
+    const uint8_t* in = blockBuffer.data() + sizeof(header);
+    const uint8_t* end = blockBuffer.data() + blockBuffer.size();
+    if (header.magic != BLOCK_MAGIC || header.count != info.count || header.count == 0 ||
+        header.checksum != checksum(in, end - in)) {
+        return false;
+    }
+
+    size_t count = header.count;
+    out.timestampNs.resize(count);
+    out.priceTicks.resize(count);
+    out.quantity.resize(count);
+    out.aggressorSide.resize(count);
+    scratch.resize(count);
+
+    // Timestamps: varints -> delta-of-deltas -> deltas -> absolute
+    const uint8_t* columnEnd = in + header.timestampBytes;
+    if (columnEnd > end || !get_varints(in, columnEnd, count - 1, scratch.data())) return false;
+    int64_t* timestamps = out.timestampNs.data();
+    unzigzag(scratch.data(), timestamps + 1, count - 1);
+    timestamps[0] = header.firstTimestampNs;
+    int64_t delta = 0;
+    for (size_t i = 1; i < count; ++i) {
+        delta += timestamps[i];
+        timestamps[i] = timestamps[i - 1] + delta;
+    }
+    in = columnEnd;
+
+    // Prices: varints -> tick deltas -> absolute ticks
+    columnEnd = in + header.priceBytes;
+    if (columnEnd > end || !get_varints(in, columnEnd, count - 1, scratch.data())) return false;
+    int64_t* prices = out.priceTicks.data();
+    unzigzag(scratch.data(), prices + 1, count - 1);
+    prices[0] = header.firstPriceTicks;
+    for (size_t i = 1; i < count; ++i) {
+        prices[i] += prices[i - 1];
+    }
+    in = columnEnd;
+
+    columnEnd = in + header.quantityBytes;
+    if (columnEnd > end || !get_varints(in, columnEnd, count, scratch.data())) return false;
+    for (size_t i = 0; i < count; ++i) {
+        out.quantity[i] = static_cast<int32_t>(scratch[i]);
+    }
+    in = columnEnd;
+
+    if (in + header.sideBytes > end || header.sideBytes < (count + 7) / 8) return false;
+    for (size_t i = 0; i < count; ++i) {
+        out.aggressorSide[i] = (in[i / 8] >> (i % 8)) & 1;
+    }
+    return true;
+}
+
+size_t TradeTapeReader::scan(const std::function<void(const TapeColumns&)>& visit) {
+    TapeColumns columns;
+    size_t trades = 0;
+    for (size_t block = 0; block < blocks.size(); ++block) {
+        if (!read_block(block, columns)) {
+            std::cerr << "Error: corrupt trade tape block " << block << std::endl;
+            break;
+        }
+        visit(columns);
+        trades += columns.size();
+    }
+    return trades;
+}
+
+std::vector<TapeBar> build_bars(TradeTapeReader& reader, int64_t intervalNs) {
+    std::vector<TapeBar> bars;
+    reader.scan([&bars, intervalNs](const TapeColumns& columns) {
+        for (size_t i = 0; i < columns.size(); ++i) {
+            int64_t start = columns.timestampNs[i] - columns.timestampNs[i] % intervalNs;
+            int64_t price = columns.priceTicks[i];
+            if (bars.empty() || bars.back().startNs != start) {
+                bars.push_back({start, price, price, price, price, 0, 0});
+            }
+            TapeBar& bar = bars.back();
+            bar.high = std::max(bar.high, price);
+            bar.low = std::min(bar.low, price);
+            bar.close = price;
+            bar.volume += columns.quantity[i];
+            bar.trades++;
+        }
+    });
+    return bars;
+}
@@ -0,0 +1,157 @@
+// tradeTape.hpp
+#ifndef TRADETAPE_HPP
+#define TRADETAPE_HPP
+
+#include "order.hpp"
+#include "instrument.hpp"
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <fstream>
+#include <functional>
+#include <mutex>
+#include <queue>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+// Trades of one symbol held column by column, as buffered by the writer and
+// returned by the reader for one block
+struct TapeColumns {
+    std::vector<int64_t> timestampNs;
+    std::vector<int64_t> priceTicks;
+    std::vector<int32_t> quantity;
+    std::vector<uint8_t> aggressorSide;    // BUY or SELL
+
+    size_t size() const { return timestampNs.size(); }
+    void reserve(size_t n);
+    void clear();
+};
+
+// Block index entry, stored in <symbol>.tidx next to <symbol>.tape
+struct TapeBlockInfo {
+    uint64_t offset;
+    uint32_t count;
+    uint32_t size;
+    int64_t firstTimestampNs;
+    int64_t lastTimestampNs;
+};
+
+// Archives trades per symbol in delta-encoded column blocks:
+// timestamps as zigzag varint delta-of-deltas, prices as zigzag varint tick
+// deltas, quantities as varints and aggressor sides as a bitmap.
+// record() only appends to in-memory columns; full blocks are encoded and
+// written by a background thread. That thread also watches the oldest open
+// block and, once it has been filling for MAX_BLOCK_AGE_NS, asks the matching
+// thread to hand aged blocks over: the next record() does, and so does
+// flush_aged() from whoever owns the engine while the book is quiet. The
+// buffers are never locked.
+class TradeTapeWriter {
+public:
+    static constexpr size_t BLOCK_TRADES = 4096;
+    static constexpr int64_t MAX_BLOCK_AGE_NS = 1000000000;
+
+    // Prices are stored in ticks of the instrument's finest tick, or defaultTickSize
+    TradeTapeWriter(const std::string& directory, double defaultTickSize = 0.01,
+                    const InstrumentMaster* instruments = nullptr);
+    ~TradeTapeWriter();
+
+    bool start();
+    void stop();
+
+    // Matching thread only
+    void record(const ExecutionReport& report);
+    void append(const std::string& symbol, int64_t timestampNs, double price, int quantity, OrderType aggressorSide);
+    void flush();
+    // Submits every block older than MAX_BLOCK_AGE_NS if the writer asked for it
+    void flush_aged();
+
+    // Any thread; true once some open block is older than MAX_BLOCK_AGE_NS
+    bool flush_due() const { return flushRequested.load(std::memory_order_relaxed); }
+
+    size_t get_trades_written() const { return tradesWritten.load(); }
+    size_t get_bytes_written() const { return bytesWritten.load(); }
+
+private:
+    struct SymbolBuffer {
+        double tickSize = 0.0;
+        int64_t startedNs = 0;    // steady clock, first trade of the current block
+        TapeColumns columns;
+    };
+    struct PendingBlock {
+        std::string symbol;
+        double tickSize;
+        TapeColumns columns;
+    };
+    struct TapeFile {
+        std::ofstream data;
+        std::ofstream index;
+        uint64_t offset = 0;
+    };
+
+    std::string directory;
+    double defaultTickSize;
+    const InstrumentMaster* instruments;
+
+    // Owned by the matching thread
+    std::unordered_map<std::string, SymbolBuffer> buffers;
+    // Start of the oldest open block (steady clock, 0 when none), or earlier
+    std::atomic<int64_t> oldestOpenNs;
+    std::atomic<bool> flushRequested;      // set by the writer, cleared by the matching thread
+
+    // Hand-off to the writer thread
+    std::queue<PendingBlock> pending;
+    std::mutex queueMutex;
+    std::condition_variable queueCondition;
+    std::thread writerThread;
+    std::atomic<bool> running;
+
+    // Owned by the writer thread
+    std::unordered_map<std::string, TapeFile> files;
+    std::vector<uint8_t> encodeBuffer;
+    std::atomic<size_t> tradesWritten;
+    std::atomic<size_t> bytesWritten;
+
+    SymbolBuffer& buffer_for(const std::string& symbol);
+    void submit_block(const std::string& symbol, SymbolBuffer& buffer);
+    void writer_worker();
+    void write_block(const PendingBlock& block);
+    TapeFile* open_tape(const std::string& symbol, double tickSize);
+};
+
+class TradeTapeReader {
+public:
+    bool open(const std::string& directory, const std::string& symbol);
+
+    double get_tick_size() const { return tickSize; }
+    size_t get_block_count() const { return blocks.size(); }
+    const TapeBlockInfo& get_block_info(size_t block) const { return blocks[block]; }
+
+    bool read_block(size_t block, TapeColumns& out);
+
+    // Decodes every block in order and returns the number of trades visited
+    size_t scan(const std::function<void(const TapeColumns&)>& visit);
+
+private:
+    std::ifstream data;
+    double tickSize = 0.0;
+    std::vector<TapeBlockInfo> blocks;
+    std::vector<uint8_t> blockBuffer;
+    std::vector<uint64_t> scratch;
+};
+
+// OHLCV bar rebuilt from a tape; prices in ticks
+struct TapeBar {
+    int64_t startNs;
+    int64_t open;
+    int64_t high;
+    int64_t low;
+    int64_t close;
+    int64_t volume;
+    uint32_t trades;
+};
+
+std::vector<TapeBar> build_bars(TradeTapeReader& reader, int64_t intervalNs);
+
+#endif
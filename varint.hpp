@@ -0,0 +1,62 @@
+// varint.hpp
+#ifndef VARINT_HPP
+#define VARINT_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// Helpers shared by the delta-encoded archive formats (trade tape, journal):
+// zigzag LEB128 varints and the FNV-1a block checksum.
+
+inline uint64_t zigzag(int64_t value) {
+    return (static_cast<uint64_t>(value) << 1) ^ static_cast<uint64_t>(value >> 63);
+}
+
+inline int64_t unzigzag(uint64_t value) {
+    return static_cast<int64_t>(value >> 1) ^ -static_cast<int64_t>(value & 1);
+}
+
+inline void put_varint(std::vector<uint8_t>& out, uint64_t value) {
+    while (value >= 0x80) {
+        out.push_back(static_cast<uint8_t>(value | 0x80));
+        value >>= 7;
+    }
+    out.push_back(static_cast<uint8_t>(value));
+}
+
+// Into a buffer with room for MAX_VARINT_BYTES; returns the new end
+constexpr size_t MAX_VARINT_BYTES = 10;
+inline uint8_t* put_varint(uint8_t* out, uint64_t value) {
+    while (value >= 0x80) {
+        *out++ = static_cast<uint8_t>(value | 0x80);
+        value >>= 7;
+    }
+    *out++ = static_cast<uint8_t>(value);
+    return out;
+}
+
+// Returns the position after the varint, or nullptr on overrun
+inline const uint8_t* get_varint(const uint8_t* in, const uint8_t* end, uint64_t& out) {
+    uint64_t value = 0;
+    int shift = 0;
+    while (true) {
+        if (in == end || shift > 63) return nullptr;
+        uint8_t byte = *in++;
+        value |= static_cast<uint64_t>(byte & 0x7f) << shift;
+        if (!(byte & 0x80)) break;
+        shift += 7;
+    }
+    out = value;
+    return in;
+}
+
+inline uint32_t checksum(const uint8_t* data, size_t size) {
+    uint32_t hash = 2166136261u;
+    for (size_t i = 0; i < size; ++i) {
+        hash = (hash ^ data[i]) * 16777619u;
+    }
+    return hash;
+}
+
+#endif
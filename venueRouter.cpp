@@ -0,0 +1,315 @@
+// venueRouter.cpp
+#include "venueRouter.hpp"
+#include <algorithm>
+#include <limits>
+
+void ConsolidatedBook::apply(size_t venue, OrderType side, double price, int delta) {
+    auto update = [venue, delta](auto& levels, double levelPrice) {
+        auto it = levels.try_emplace(levelPrice).first;
+        auto& quantities = it->second;
+        if (quantities.size() <= venue) quantities.resize(venue + 1, 0);
+        quantities[venue] += delta;
+
+        if (delta < 0 && std::all_of(quantities.begin(), quantities.end(), [](int quantity) { return quantity <= 0; })) {
+            levels.erase(it);
+        }
+    };
+
+    if (side == BUY) {
+        update(bids, price);
+    } else {
+        update(asks, price);
+    }
+}
+
+VenueSet::VenueSet(uint64_t seed) : rng(seed) {
+}
+
+size_t VenueSet::add_venue(const VenueProfile& profile) {
+    venues.push_back({profile, {}});
+    return venues.size() - 1;
+}
+
+MatchingEngine& VenueSet::engine(size_t venue, const std::string& symbol) {
+    return *venue_book(venue, symbol).engine;
+}
+
+VenueSet::VenueBook& VenueSet::venue_book(size_t venue, const std::string& symbol) {
+    VenueBook& book = venues[venue].books[symbol];
+    if (!book.engine) {
+        book.engine.reset(new MatchingEngine());
+        book.symbolId = book.engine->symbol_id(symbol);
+
+        ConsolidatedBook* consolidatedBook = &books[symbol];
+        book.engine->set_level_callback([consolidatedBook, venue](OrderType side, double price, int delta) {
+            consolidatedBook->apply(venue, side, price, delta);
+        });
+        book.engine->set_execution_callback([this, venue, &book](const ExecutionReport& report) {
+            on_execution(venue, book, report);
+        });
+    }
+    return book;
+}
+
+int64_t VenueSet::latency(size_t venue) {
+    const VenueProfile& profile = venues[venue].profile;
+    if (profile.jitterNs <= 0) return profile.latencyNs;
+    return profile.latencyNs + static_cast<int64_t>(rng() % static_cast<uint64_t>(profile.jitterNs + 1));
+}
+
+void VenueSet::push(Event event) {
+    event.sequence = ++eventSequence;
+    events.push(std::move(event));
+}
+
+uint64_t VenueSet::send_order(size_t venue, const std::string& symbol, OrderType side, double price, int quantity,
+                              bool immediateOrCancel) {
+    uint64_t childId = ++childCounter;
+    Event event{};
+    event.time = clock + latency(venue);
+    event.kind = ORDER_ARRIVAL;
+    event.venue = venue;
+    event.childId = childId;
+    event.symbol = symbol;
+    event.side = side;
+    event.price = price;
+    event.quantity = quantity;
+    event.immediateOrCancel = immediateOrCancel;
+    push(std::move(event));
+    return childId;
+}
+
+void VenueSet::send_cancel(uint64_t childId) {
+    auto it = children.find(childId);
+    if (it == children.end()) return;
+
+    Event event{};
+    event.time = clock + latency(it->second.venue);
+    event.kind = CANCEL_ARRIVAL;
+    event.venue = it->second.venue;
+    event.childId = childId;
+    push(std::move(event));
+}
+
+void VenueSet::schedule_order(size_t venue, int64_t atNs, const std::string& symbol, OrderType side, double price, int quantity) {
+    Event event{};
+    event.time = std::max(atNs, clock);
+    event.kind = ORDER_ARRIVAL;
+    event.venue = venue;
+    event.childId = 0;
+    event.symbol = symbol;
+    event.side = side;
+    event.price = price;
+    event.quantity = quantity;
+    push(std::move(event));
+}
+
+void VenueSet::run_until(int64_t t) {
+    while (!events.empty() && events.top().time <= t) {
+        Event event = events.top();
+        events.pop();
+        clock = event.time;
+        deliver(event);
+    }
+    clock = std::max(clock, t);
+}
+
+void VenueSet::deliver(const Event& event) {
+    switch (event.kind) {
+    case ORDER_ARRIVAL: {
+        VenueBook& book = venue_book(event.venue, event.symbol);
+        if (event.childId == 0) {
+            book.engine->submit_order(event.side, event.price, event.quantity, event.symbol, book.symbolId, "FLOW");
+            return;
+        }
+
+        submittingChild = event.childId;
+        std::string orderId = book.engine->submit_order(event.side, event.price, event.quantity, event.symbol, book.symbolId, "SOR");
+        submittingChild = 0;
+
+        auto order = orderId.empty() ? nullptr : book.engine->get_order(orderId);
+        if (!order || order->getRemainingQuantity() == 0) {
+            // Rejected, or fully filled on arrival (already reported)
+            if (orderId.empty()) report(event.venue, event.childId, event.price, 0, 0, false);
+            return;
+        }
+        if (event.immediateOrCancel) {
+            book.engine->cancel_order(orderId);
+            report(event.venue, event.childId, event.price, 0, 0, false);
+            return;
+        }
+
+        // Resting: acknowledge and watch for passive fills
+        book.children[orderId] = event.childId;
+        children[event.childId] = {event.venue, event.symbol, orderId, order->getRemainingQuantity()};
+        report(event.venue, event.childId, event.price, 0, order->getRemainingQuantity(), false);
+        break;
+    }
+    case CANCEL_ARRIVAL: {
+        auto it = children.find(event.childId);
+        if (it == children.end()) return;   // filled while the cancel was in flight
+
+        Child& child = it->second;
+        VenueBook& book = venue_book(child.venue, child.symbol);
+        book.engine->cancel_order(child.orderId);
+        book.children.erase(child.orderId);
+        report(child.venue, event.childId, 0.0, 0, 0, false);
+        children.erase(it);
+        break;
+    }
+    case REPORT_ARRIVAL:
+        if (onReport) onReport(event.report);
+        break;
+    }
+}
+
+void VenueSet::on_execution(size_t venue, VenueBook& book, const ExecutionReport& execution) {
+    if (submittingChild != 0) {
+        report(venue, submittingChild, execution.averagePrice, execution.filledQuantity,
+               execution.remainingQuantity, false);
+    }
+    if (book.children.empty()) return;
+
+    for (const auto& fill : execution.fills) {
+        auto it = book.children.find(fill.passiveOrderId);
+        if (it == book.children.end()) continue;
+
+        uint64_t childId = it->second;
+        Child& child = children[childId];
+        child.leaves -= fill.quantity;
+        report(venue, childId, fill.price, fill.quantity, child.leaves, true);
+        if (child.leaves <= 0) {
+            book.children.erase(it);
+            children.erase(childId);
+        }
+    }
+}
+
+void VenueSet::report(size_t venue, uint64_t childId, double price, int quantity, int leaves, bool passive) {
+    const VenueProfile& profile = venues[venue].profile;
+    Event event{};
+    event.time = clock + latency(venue);
+    event.kind = REPORT_ARRIVAL;
+    event.venue = venue;
+    event.childId = childId;
+    event.report = {childId, venue, price, quantity, leaves,
+                    quantity * (passive ? profile.makerFee : profile.takerFee), passive, event.time};
+    push(std::move(event));
+}
+
+SmartOrderRouter::SmartOrderRouter(VenueSet& venueSet) : venues(venueSet) {
+    venues.set_report_callback([this](const ChildReport& report) {
+        on_report(report);
+    });
+}
+
+template <typename Levels>
+void SmartOrderRouter::collect_slices(const Levels& levels, OrderType side, int quantity, double limit) {
+    double minFee = std::numeric_limits<double>::max();
+    double maxFee = std::numeric_limits<double>::lowest();
+    for (size_t v = 0; v < venues.venue_count(); ++v) {
+        minFee = std::min(minFee, venues.get_venue(v).takerFee);
+        maxFee = std::max(maxFee, venues.get_venue(v).takerFee);
+    }
+
+    // Walk until the quantity is covered, then a little further: a deeper level
+    // on a cheap venue can still beat a better price on an expensive one
+    int covered = 0;
+    double bound = limit;
+    for (const auto& level : levels) {
+        double price = level.first;
+        if ((side == BUY) ? price > bound : price < bound) break;
+
+        for (size_t v = 0; v < level.second.size(); ++v) {
+            if (level.second[v] <= 0) continue;
+            double fee = venues.get_venue(v).takerFee;
+            slices.push_back({(side == BUY) ? price + fee : price - fee, price, v, level.second[v]});
+            covered += level.second[v];
+        }
+        if (covered >= quantity && bound == limit) {
+            bound = (side == BUY) ? std::min(limit, price + (maxFee - minFee))
+                                  : std::max(limit, price - (maxFee - minFee));
+        }
+    }
+
+    std::stable_sort(slices.begin(), slices.end(), [side](const Slice& a, const Slice& b) {
+        return (side == BUY) ? a.allInPrice < b.allInPrice : a.allInPrice > b.allInPrice;
+    });
+}
+
+uint64_t SmartOrderRouter::route(const std::string& symbol, OrderType side, int quantity, double limit, bool postResidual) {
+    uint64_t parentId = ++parentCounter;
+    ParentOrder& parent = parents[parentId];
+    parent.parentId = parentId;
+    parent.symbol = symbol;
+    parent.side = side;
+    parent.quantity = quantity;
+    parent.limit = limit;
+    parent.startNs = venues.now();
+
+    slices.clear();
+    const ConsolidatedBook& book = venues.consolidated(symbol);
+    if (side == BUY) {
+        collect_slices(book.asks, side, quantity, limit);
+    } else {
+        collect_slices(book.bids, side, quantity, limit);
+    }
+
+    // One child per venue for everything taken there, limited at the worst price taken
+    std::vector<int> venueQuantity(venues.venue_count(), 0);
+    std::vector<double> venuePrice(venues.venue_count(), 0.0);
+    int remaining = quantity;
+    for (const auto& slice : slices) {
+        if (remaining == 0) break;
+        int take = std::min(remaining, slice.quantity);
+        venueQuantity[slice.venue] += take;
+        venuePrice[slice.venue] = (venueQuantity[slice.venue] == take) ? slice.price
+            : (side == BUY) ? std::max(venuePrice[slice.venue], slice.price)
+                            : std::min(venuePrice[slice.venue], slice.price);
+        remaining -= take;
+    }
+
+    for (size_t v = 0; v < venueQuantity.size(); ++v) {
+        if (venueQuantity[v] == 0) continue;
+        uint64_t childId = venues.send_order(v, symbol, side, venuePrice[v], venueQuantity[v], true);
+        parentOfChild[childId] = parentId;
+        parent.openChildren++;
+    }
+
+    if (postResidual && remaining > 0 && venues.venue_count() > 0) {
+        size_t cheapest = 0;
+        for (size_t v = 1; v < venues.venue_count(); ++v) {
+            if (venues.get_venue(v).makerFee < venues.get_venue(cheapest).makerFee) cheapest = v;
+        }
+        uint64_t childId = venues.send_order(cheapest, symbol, side, limit, remaining, false);
+        parentOfChild[childId] = parentId;
+        parent.openChildren++;
+    }
+
+    if (parent.openChildren == 0) {
+        parent.doneNs = parent.startNs;
+    }
+    return parentId;
+}
+
+const ParentOrder* SmartOrderRouter::get_parent(uint64_t parentId) const {
+    auto it = parents.find(parentId);
+    return (it != parents.end()) ? &it->second : nullptr;
+}
+
+void SmartOrderRouter::on_report(const ChildReport& report) {
+    auto it = parentOfChild.find(report.childId);
+    if (it == parentOfChild.end()) return;
+
+    ParentOrder& parent = parents[it->second];
+    parent.filled += report.quantity;
+    parent.notional += report.price * report.quantity;
+    parent.fees += report.fee;
+
+    if (report.leaves == 0) {
+        parentOfChild.erase(it);
+        if (--parent.openChildren == 0) {
+            parent.doneNs = report.timestampNs;
+        }
+    }
+}
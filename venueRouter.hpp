@@ -0,0 +1,181 @@
+// venueRouter.hpp
+#ifndef VENUEROUTER_HPP
+#define VENUEROUTER_HPP
+
+#include "matchingEngine.hpp"
+#include <cstdint>
+#include <functional>
+#include <map>
+#include <memory>
+#include <queue>
+#include <random>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+struct VenueProfile {
+    std::string name;
+    int64_t latencyNs;      // one way between router and venue
+    int64_t jitterNs;       // uniform extra delay added to each message
+    double makerFee;        // per share; negative is a rebate
+    double takerFee;        // per share
+};
+
+// Resting depth of one symbol across venues: per price, one quantity per venue.
+// Maintained from the venues' level change events, never rebuilt.
+struct ConsolidatedBook {
+    std::map<double, std::vector<int>, std::greater<double>> bids;
+    std::map<double, std::vector<int>> asks;
+
+    void apply(size_t venue, OrderType side, double price, int delta);
+};
+
+// What the router hears back about a child order, delayed by the venue's latency
+struct ChildReport {
+    uint64_t childId;
+    size_t venue;
+    double price;
+    int quantity;           // filled by this report; 0 for a cancel
+    int leaves;             // still open at the venue; 0 once the child is done
+    double fee;
+    bool passive;
+    int64_t timestampNs;    // simulated time the report reaches the router
+};
+
+// Several in-process venues on one simulated clock. Each (venue, symbol) has its
+// own MatchingEngine, created on first use. Orders, cancels and reports are
+// events delivered in time order with each venue's latency, so a whole backtest
+// runs single-threaded and many venues and symbols fit on one core.
+class VenueSet {
+public:
+    using ReportCallback = std::function<void(const ChildReport&)>;
+
+    explicit VenueSet(uint64_t seed = 1);
+
+    size_t add_venue(const VenueProfile& profile);
+    size_t venue_count() const { return venues.size(); }
+    const VenueProfile& get_venue(size_t venue) const { return venues[venue].profile; }
+
+    // Direct access, e.g. to seed liquidity at the current time
+    MatchingEngine& engine(size_t venue, const std::string& symbol);
+    const ConsolidatedBook& consolidated(const std::string& symbol) { return books[symbol]; }
+
+    // Router traffic: reaches the venue after its latency. Returns the child ID.
+    uint64_t send_order(size_t venue, const std::string& symbol, OrderType side, double price, int quantity,
+                        bool immediateOrCancel);
+    void send_cancel(uint64_t childId);
+
+    // Other participants' flow arriving at a venue at the given time
+    void schedule_order(size_t venue, int64_t atNs, const std::string& symbol, OrderType side, double price, int quantity);
+
+    void set_report_callback(ReportCallback callback) { onReport = std::move(callback); }
+
+    // Delivers every event up to and including t, then sets the clock to t
+    void run_until(int64_t t);
+    int64_t now() const { return clock; }
+    size_t pending_events() const { return events.size(); }
+
+private:
+    enum EventKind { ORDER_ARRIVAL, CANCEL_ARRIVAL, REPORT_ARRIVAL };
+    struct Event {
+        int64_t time;
+        uint64_t sequence;
+        EventKind kind;
+        size_t venue;
+        uint64_t childId;
+        std::string symbol;
+        OrderType side;
+        double price;
+        int quantity;
+        bool immediateOrCancel;
+        ChildReport report;
+    };
+    struct LaterEvent {
+        bool operator()(const Event& a, const Event& b) const {
+            return a.time != b.time ? a.time > b.time : a.sequence > b.sequence;
+        }
+    };
+    struct VenueBook {
+        std::unique_ptr<MatchingEngine> engine;
+        uint32_t symbolId = InstrumentMaster::INVALID_SYMBOL_ID;  // resolved when the book is created
+        std::unordered_map<std::string, uint64_t> children;    // engine order ID -> child ID
+    };
+    struct Venue {
+        VenueProfile profile;
+        std::unordered_map<std::string, VenueBook> books;
+    };
+    struct Child {
+        size_t venue;
+        std::string symbol;
+        std::string orderId;
+        int leaves;
+    };
+
+    std::vector<Venue> venues;
+    std::unordered_map<std::string, ConsolidatedBook> books;
+    std::unordered_map<uint64_t, Child> children;
+    std::priority_queue<Event, std::vector<Event>, LaterEvent> events;
+    ReportCallback onReport;
+    std::mt19937_64 rng;
+    int64_t clock = 0;
+    uint64_t eventSequence = 0;
+    uint64_t childCounter = 0;
+    uint64_t submittingChild = 0;   // child whose order is inside submit_order right now
+
+    VenueBook& venue_book(size_t venue, const std::string& symbol);
+    int64_t latency(size_t venue);
+    void push(Event event);
+    void deliver(const Event& event);
+    void on_execution(size_t venue, VenueBook& book, const ExecutionReport& report);
+    void report(size_t venue, uint64_t childId, double price, int quantity, int leaves, bool passive);
+};
+
+struct ParentOrder {
+    uint64_t parentId;
+    std::string symbol;
+    OrderType side;
+    int quantity;
+    double limit;
+    int filled = 0;
+    double notional = 0.0;
+    double fees = 0.0;
+    int openChildren = 0;
+    int64_t startNs = 0;
+    int64_t doneNs = 0;     // when the last child report arrived
+
+    double average_price() const { return filled > 0 ? notional / filled : 0.0; }
+};
+
+// Splits parent orders across venues. Liquidity is taken from the consolidated
+// book cheapest all-in (price plus taker fee) first, with one immediate-or-cancel
+// child per venue limited to the worst price taken there. Whatever the visible
+// depth cannot fill within the limit can rest at the venue with the lowest
+// maker fee. Children arrive after their venue's latency, so the depth the
+// split was based on may be gone by then.
+class SmartOrderRouter {
+public:
+    explicit SmartOrderRouter(VenueSet& venues);
+
+    uint64_t route(const std::string& symbol, OrderType side, int quantity, double limit, bool postResidual = false);
+    const ParentOrder* get_parent(uint64_t parentId) const;
+
+private:
+    struct Slice {
+        double allInPrice;
+        double price;
+        size_t venue;
+        int quantity;
+    };
+
+    VenueSet& venues;
+    std::unordered_map<uint64_t, ParentOrder> parents;
+    std::unordered_map<uint64_t, uint64_t> parentOfChild;
+    std::vector<Slice> slices;
+    uint64_t parentCounter = 0;
+
+    template <typename Levels>
+    void collect_slices(const Levels& levels, OrderType side, int quantity, double limit);
+    void on_report(const ChildReport& report);
+};
+
+#endif
@@ -0,0 +1,146 @@
+// warmup.cpp
+#include "warmup.hpp"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <random>
+#include <string>
+#include <vector>
+
+namespace {
+
+// Keeps the shadow book at a realistic size
+constexpr size_t MAX_RESTING = 4096;
+constexpr size_t STEADY_WINDOWS = 3;
+
+struct FlowShape {
+    std::string symbol = "WARMUP";
+    double tick = 0.01;
+    double mid = 100.0;
+    int lot = 1;
+};
+
+FlowShape flow_shape(const InstrumentMaster* instruments) {
+    FlowShape shape;
+    if (!instruments || instruments->empty()) return shape;
+
+    const Instrument& instrument = instruments->get(0);
+    int64_t mid = 100 * InstrumentMaster::PRICE_SCALE;
+    if (instrument.maxPrice > 0) {
+        mid = (instrument.minPrice + instrument.maxPrice) / 2;
+    } else if (instrument.minPrice > 0) {
+        mid = instrument.minPrice * 2;
+    }
+    int64_t tick = instrument.tick_size_at(mid);
+    mid -= mid % tick;
+
+    shape.symbol = instrument.symbol;
+    shape.tick = InstrumentMaster::from_price_units(tick);
+    shape.mid = InstrumentMaster::from_price_units(mid);
+    shape.lot = instrument.lotSize;
+    return shape;
+}
+
+double median(std::vector<int64_t>& samples) {
+    auto middle = samples.begin() + samples.size() / 2;
+    std::nth_element(samples.begin(), middle, samples.end());
+    return static_cast<double>(*middle);
+}
+
+} // namespace
+
+WarmupReport run_warmup(MatchingEngine& live, const WarmupOptions& options, const InstrumentMaster* instruments,
+                        double hotWindow, const MatchingEngine::ExecutionCallback& publish) {
+    using Clock = std::chrono::steady_clock;
+
+    WarmupReport report;
+    FlowShape shape = flow_shape(instruments);
+    size_t windowOrders = std::max<size_t>(options.windowOrders, 16);
+    size_t peakOrders = 0;
+
+    {
+        MatchingEngine shadow;
+        shadow.set_instrument_master(instruments);
+        uint32_t symbolId = shadow.symbol_id(shape.symbol);
+        if (hotWindow > 0) shadow.set_hot_window(hotWindow);
+        shadow.set_execution_callback([&report, &publish](const ExecutionReport& execution) {
+            report.executions++;
+            if (publish) publish(execution);
+        });
+
+        std::mt19937_64 rng(12345);
+        std::vector<std::string> resting;
+        resting.reserve(MAX_RESTING);
+        std::vector<int64_t> window;
+        window.reserve(windowOrders);
+        std::vector<double> medians;
+        int64_t midTicks = 0;
+
+        auto start = Clock::now();
+        auto deadline = start + std::chrono::milliseconds(options.durationMs);
+        while (true) {
+            if ((report.orders & 255) == 0 && Clock::now() >= deadline) break;
+
+            unsigned roll = rng() % 100;
+            int64_t offset = static_cast<int64_t>(rng() % 11) - 5;
+            double price = shape.mid + (midTicks + offset) * shape.tick;
+            int quantity = shape.lot * static_cast<int>(1 + rng() % 10);
+            if (rng() % 16 == 0) {
+                midTicks += (rng() & 1) ? 1 : -1;
+                midTicks = std::max<int64_t>(-50, std::min<int64_t>(50, midTicks));
+            }
+
+            auto begin = Clock::now();
+            if (roll < 15 && !resting.empty()) {
+                size_t pick = rng() % resting.size();
+                shadow.cancel_order(resting[pick]);
+                resting[pick] = std::move(resting.back());
+                resting.pop_back();
+                report.cancels++;
+            } else if (roll < 20 && !resting.empty()) {
+                shadow.modify_order(resting[rng() % resting.size()], price, quantity);
+            } else {
+                // Buys lean above the mid and sells below, so about half the flow trades
+                OrderType side = (rng() & 1) ? BUY : SELL;
+                if (side == SELL) price -= 2 * shape.tick;
+                std::string orderId = shadow.submit_order(side, price, quantity, shape.symbol, symbolId, "WARMUP");
+                if (!orderId.empty()) {
+                    if (resting.size() == MAX_RESTING) {
+                        shadow.cancel_order(resting.front());
+                        resting.front() = std::move(resting.back());
+                        resting.pop_back();
+                    }
+                    resting.push_back(std::move(orderId));
+                }
+            }
+            window.push_back(std::chrono::duration_cast<std::chrono::nanoseconds>(Clock::now() - begin).count());
+            report.orders++;
+
+            if (window.size() == windowOrders) {
+                medians.push_back(median(window));
+                window.clear();
+            }
+            peakOrders = std::max(peakOrders, resting.size());
+        }
+        report.seconds = std::chrono::duration<double>(Clock::now() - start).count();
+
+        if (!medians.empty()) {
+            report.firstMedianNs = medians.front();
+            report.finalMedianNs = medians.back();
+        }
+        // Steady once the last group of windows is no faster or slower than the group
+        // before it; medians of groups keep one noisy window from deciding
+        if (medians.size() >= 2 * STEADY_WINDOWS) {
+            std::vector<double> last(medians.end() - STEADY_WINDOWS, medians.end());
+            std::vector<double> previous(medians.end() - 2 * STEADY_WINDOWS, medians.end() - STEADY_WINDOWS);
+            std::sort(last.begin(), last.end());
+            std::sort(previous.begin(), previous.end());
+            double lastMedian = last[STEADY_WINDOWS / 2];
+            double previousMedian = previous[STEADY_WINDOWS / 2];
+            report.steady = std::abs(lastMedian - previousMedian) <= previousMedian * options.tolerance;
+        }
+    }
+
+    live.reserve(std::max(options.reserveOrders, peakOrders * 2));
+    return report;
+}
@@ -0,0 +1,36 @@
+// warmup.hpp
+#ifndef WARMUP_HPP
+#define WARMUP_HPP
+
+#include "matchingEngine.hpp"
+#include <cstdint>
+
+struct WarmupOptions {
+    int64_t durationMs = 200;
+    size_t windowOrders = 1000;     // latency medians are compared window by window
+    double tolerance = 0.10;        // steady once recent window medians stop moving by more than this
+    size_t reserveOrders = 65536;   // minimum order capacity to presize in the live engine
+};
+
+struct WarmupReport {
+    uint64_t orders = 0;
+    uint64_t cancels = 0;
+    uint64_t executions = 0;
+    double seconds = 0.0;
+    double firstMedianNs = 0.0;     // first window
+    double finalMedianNs = 0.0;     // last window
+    bool steady = false;
+};
+
+// Start-of-day warm-up, run before accepting traffic. Drives synthetic order
+// flow (crossing and resting submits, modifies, cancels) through a shadow
+// engine configured like the live one, publishing executions through the
+// given callback, so code, branch predictors and the allocator's free lists
+// are warm. The shadow book is thrown away afterwards; the live engine only
+// gets its order lookup presized to the peak the shadow book reached.
+// With an instrument master the flow uses the first instrument's tick and lot.
+WarmupReport run_warmup(MatchingEngine& live, const WarmupOptions& options,
+                        const InstrumentMaster* instruments = nullptr, double hotWindow = 0.0,
+                        const MatchingEngine::ExecutionCallback& publish = nullptr);
+
+#endif
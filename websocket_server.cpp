@@ -3,7 +3,8 @@
 #include <sstream>
 #include <iomanip>
 
-WebSocketServer::WebSocketServer() : m_running(false) {
+WebSocketServer::WebSocketServer()
+    : m_running(false), m_publisher_running(false), m_compressed_bytes(0), m_uncompressed_bytes(0) {
     // Initialize the server
     m_server.init_asio();
     
@@ -35,6 +36,9 @@ bool WebSocketServer::start(int port) {
         m_server.start_accept();
         m_running = true;
         
+        m_publisher_running = true;
+        m_publisher_thread = std::thread(&WebSocketServer::publisher_worker, this);
+        
         std::cout << "WebSocket server started on port " << port << std::endl;
         return true;
     } catch (const std::exception& e) {
@@ -50,6 +54,15 @@ void WebSocketServer::stop() {
         if (m_server_thread.joinable()) {
             m_server_thread.join();
         }
+        
+        {
+            std::lock_guard<std::mutex> lock(m_publisher_mutex);
+            m_publisher_running = false;
+        }
+        m_publisher_condition.notify_one();
+        if (m_publisher_thread.joinable()) {
+            m_publisher_thread.join();
+        }
         std::cout << "WebSocket server stopped" << std::endl;
     }
 }
@@ -67,6 +80,13 @@ void WebSocketServer::run() {
 }
 
 void WebSocketServer::on_open(connection_hdl hdl) {
+    // The handshake response says whether permessage-deflate was accepted and
+    // with which server-side window and context takeover
+    PublisherEvent event{PublisherEvent::OPEN, hdl, false, DeflateParams(), BROADCAST_TRADE, ""};
+    server::connection_ptr con = m_server.get_con_from_hdl(hdl);
+    event.deflate = DeflateParams::parse(con->get_response_header("Sec-WebSocket-Extensions"), event.params);
+    enqueue(std::move(event));
+    
     std::lock_guard<std::mutex> lock(m_connection_mutex);
     m_connections.insert(hdl);
     std::cout << "Client connected. Total connections: " << m_connections.size() << std::endl;
@@ -81,6 +101,8 @@ void WebSocketServer::on_open(connection_hdl hdl) {
 }
 
 void WebSocketServer::on_close(connection_hdl hdl) {
+    enqueue({PublisherEvent::CLOSE, hdl, false, DeflateParams(), BROADCAST_TRADE, ""});
+    
     std::lock_guard<std::mutex> lock(m_connection_mutex);
     m_connections.erase(hdl);
     std::cout << "Client disconnected. Total connections: " << m_connections.size() << std::endl;
@@ -205,14 +227,7 @@ void WebSocketServer::broadcast_trade(const Trade& trade) {
             trade.timestamp.time_since_epoch()).count()}
     };
     
-    std::lock_guard<std::mutex> lock(m_connection_mutex);
-    for (auto& hdl : m_connections) {
-        try {
-            send_message(hdl, tradeData);
-        } catch (const std::exception& e) {
-            std::cerr << "Error broadcasting trade: " << e.what() << std::endl;
-        }
-    }
+    broadcast(BROADCAST_TRADE, tradeData);
 }
 
 void WebSocketServer::broadcast_orderbook_update(const std::string& symbol, double bestBid, double bestAsk, int bidSize, int askSize) {
@@ -227,14 +242,7 @@ void WebSocketServer::broadcast_orderbook_update(const std::string& symbol, doub
         {"timestamp", std::time(nullptr)}
     };
     
-    std::lock_guard<std::mutex> lock(m_connection_mutex);
-    for (auto& hdl : m_connections) {
-        try {
-            send_message(hdl, orderbookData);
-        } catch (const std::exception& e) {
-            std::cerr << "Error broadcasting orderbook update: " << e.what() << std::endl;
-        }
-    }
+    broadcast(BROADCAST_DEPTH, orderbookData);
 }
 
 void WebSocketServer::broadcast_order_status(const std::string& orderId, const std::string& status, const std::string& message) {
@@ -246,14 +254,138 @@ void WebSocketServer::broadcast_order_status(const std::string& orderId, const s
         {"timestamp", std::time(nullptr)}
     };
     
-    std::lock_guard<std::mutex> lock(m_connection_mutex);
-    for (auto& hdl : m_connections) {
-        try {
-            send_message(hdl, statusData);
-        } catch (const std::exception& e) {
-            std::cerr << "Error broadcasting order status: " << e.what() << std::endl;
+    broadcast(BROADCAST_STATUS, statusData);
+}
+
+void WebSocketServer::broadcast_depth_snapshot(const std::string& symbol,
+                                               const std::vector<std::pair<double, int>>& bids,
+                                               const std::vector<std::pair<double, int>>& asks) {
+    json snapshotData = {
+        {"type", "depth_snapshot"},
+        {"symbol", symbol},
+        {"bids", bids},
+        {"asks", asks},
+        {"timestamp", std::time(nullptr)}
+    };
+    
+    broadcast(BROADCAST_SNAPSHOT, snapshotData);
+}
+
+void WebSocketServer::broadcast_depth_update(const std::string& symbol, OrderType side, double price, int delta) {
+    json updateData = {
+        {"type", "depth_update"},
+        {"symbol", symbol},
+        {"side", order_type_to_string(side)},
+        {"price", price},
+        {"delta", delta}
+    };
+    
+    broadcast(BROADCAST_DEPTH, updateData);
+}
+
+void WebSocketServer::broadcast(BroadcastClass messageClass, const json& message) {
+    enqueue({PublisherEvent::BROADCAST, connection_hdl(), false, DeflateParams(), messageClass, message.dump()});
+}
+
+void WebSocketServer::enqueue(PublisherEvent event) {
+    {
+        std::lock_guard<std::mutex> lock(m_publisher_mutex);
+        if (!m_publisher_running) return;
+        m_publisher_queue.push(std::move(event));
+    }
+    m_publisher_condition.notify_one();
+}
+
+void WebSocketServer::publisher_worker() {
+    std::unique_lock<std::mutex> lock(m_publisher_mutex);
+    while (true) {
+        m_publisher_condition.wait(lock, [this] { return !m_publisher_queue.empty() || !m_publisher_running; });
+        if (m_publisher_queue.empty() && !m_publisher_running) break;
+        
+        PublisherEvent event = std::move(m_publisher_queue.front());
+        m_publisher_queue.pop();
+        lock.unlock();
+        
+        if (event.kind == PublisherEvent::OPEN) {
+            m_groups[event.hdl] = event.deflate ? m_deflate_groups.join(event.params) : 0;
+        } else if (event.kind == PublisherEvent::CLOSE) {
+            auto it = m_groups.find(event.hdl);
+            if (it != m_groups.end()) {
+                if (it->second != 0) m_deflate_groups.leave(it->second);
+                m_groups.erase(it);
+            }
+        } else {
+            publish(event.messageClass, event.payload);
+        }
+        
+        lock.lock();
+    }
+}
+
+// Runs on the publisher thread. Each message is built into at most one frame per
+// compression group, and that frame is sent to every member of the group.
+void WebSocketServer::publish(BroadcastClass messageClass, const std::string& payload) {
+    bool deflatable = messageClass == BROADCAST_DEPTH || messageClass == BROADCAST_SNAPSHOT;
+    if (messageClass == BROADCAST_SNAPSHOT) {
+        auto moved = m_deflate_groups.merge();
+        for (auto& entry : m_groups) {
+            auto it = moved.find(entry.second);
+            if (it != moved.end()) entry.second = it->second;
         }
     }
+    
+    std::map<DeflateGroups::GroupId, message_ptr> frames;
+    for (const auto& entry : m_groups) {
+        websocketpp::lib::error_code ec;
+        server::connection_ptr con = m_server.get_con_from_hdl(entry.first, ec);
+        if (ec) continue;
+        
+        DeflateGroups::GroupId group = deflatable ? entry.second : 0;
+        auto frame = frames.find(group);
+        if (frame == frames.end()) {
+            message_ptr msg;
+            if (group != 0) {
+                const std::string& compressed = m_deflate_groups.compress(group, payload);
+                if (!compressed.empty()) {
+                    msg = make_frame(con, compressed, true);
+                    m_compressed_bytes += compressed.size();
+                    m_uncompressed_bytes += payload.size();
+                }
+            }
+            frame = frames.emplace(group, msg ? msg : make_frame(con, payload, false)).first;
+        }
+        
+        ec = con->send(frame->second);
+        if (ec) {
+            std::cerr << "Error broadcasting message: " << ec.message() << std::endl;
+        }
+    }
+}
+
+// A complete unmasked server frame, so websocketpp sends it as is and one
+// message can go to several connections
+WebSocketServer::message_ptr WebSocketServer::make_frame(server::connection_ptr con, const std::string& payload,
+                                                         bool compressed) {
+    std::string header(1, static_cast<char>(0x80 | (compressed ? 0x40 : 0) | websocketpp::frame::opcode::text));
+    uint64_t size = payload.size();
+    if (size < 126) {
+        header += static_cast<char>(size);
+    } else if (size <= 0xffff) {
+        header += static_cast<char>(126);
+        header += static_cast<char>(size >> 8);
+        header += static_cast<char>(size & 0xff);
+    } else {
+        header += static_cast<char>(127);
+        for (int shift = 56; shift >= 0; shift -= 8) {
+            header += static_cast<char>((size >> shift) & 0xff);
+        }
+    }
+    
+    message_ptr msg = con->get_message(websocketpp::frame::opcode::text, payload.size());
+    msg->set_header(header);
+    msg->set_payload(payload);
+    msg->set_prepared(true);
+    return msg;
 }
 
 void WebSocketServer::set_matching_engine_callback(std::function<std::string(OrderType, double, int, const std::string&, const std::string&)> submit_callback) {
@@ -266,8 +398,14 @@ void WebSocketServer::set_cancel_callback(std::function<bool(const std::string&)
 
 void WebSocketServer::send_message(connection_hdl hdl, const json& message) {
     try {
+        // Never compressed: the client's decompression window must only ever
+        // see frames from its group's shared compressor
         server::connection_ptr con = m_server.get_con_from_hdl(hdl);
-        con->send(message.dump(), websocketpp::frame::opcode::text);
+        std::string payload = message.dump();
+        message_ptr msg = con->get_message(websocketpp::frame::opcode::text, payload.size());
+        msg->append_payload(payload);
+        msg->set_compressed(false);
+        con->send(msg);
     } catch (const std::exception& e) {
         std::cerr << "Error sending message: " << e.what() << std::endl;
     }
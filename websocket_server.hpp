@@ -2,21 +2,42 @@
 #define WEBSOCKET_SERVER_HPP
 
 #include <websocketpp/config/asio_no_tls.hpp>
+#include <websocketpp/extensions/permessage_deflate/enabled.hpp>
 #include <websocketpp/server.hpp>
 #include <nlohmann/json.hpp>
+#include <atomic>
+#include <condition_variable>
 #include <thread>
+#include <map>
 #include <mutex>
+#include <queue>
 #include <set>
+#include <vector>
 #include <functional>
 #include "order.hpp"
+#include "deflateGroups.hpp"
 
 using json = nlohmann::json;
 
+// asio config with permessage-deflate negotiation. The extension also inflates
+// compressed client messages; outbound compression is done by the publisher
+// (see WebSocketServer), which sends prepared frames the extension never sees.
+struct deflate_config : public websocketpp::config::asio {
+    typedef deflate_config type;
+    typedef websocketpp::config::asio base;
+
+    struct permessage_deflate_config {};
+    typedef websocketpp::extensions::permessage_deflate::enabled<permessage_deflate_config> permessage_deflate_type;
+};
+
+// Broadcast classes; only the ones that compress well are deflated
+enum BroadcastClass { BROADCAST_TRADE, BROADCAST_STATUS, BROADCAST_DEPTH, BROADCAST_SNAPSHOT };
+
 class WebSocketServer {
 public:
-    using server = websocketpp::server<websocketpp::config::asio>;
+    using server = websocketpp::server<deflate_config>;
     using connection_hdl = websocketpp::connection_hdl;
-    using message_ptr = websocketpp::config::asio::message_type::ptr;
+    using message_ptr = deflate_config::message_type::ptr;
 
     WebSocketServer();
     ~WebSocketServer();
@@ -31,6 +52,15 @@ public:
     void broadcast_orderbook_update(const std::string& symbol, double bestBid, double bestAsk, int bidSize, int askSize);
     void broadcast_order_status(const std::string& orderId, const std::string& status, const std::string& message = "");
 
+    // Depth traffic, deflated per compression group for clients that negotiated
+    // permessage-deflate. A snapshot also merges the groups (see DeflateGroups).
+    void broadcast_depth_snapshot(const std::string& symbol, const std::vector<std::pair<double, int>>& bids,
+                                  const std::vector<std::pair<double, int>>& asks);
+    void broadcast_depth_update(const std::string& symbol, OrderType side, double price, int delta);
+
+    size_t get_compressed_bytes() const { return m_compressed_bytes.load(); }
+    size_t get_uncompressed_bytes() const { return m_uncompressed_bytes.load(); }
+
     // Order handling
     void handle_order_submission(const json& orderData, connection_hdl hdl);
     void handle_order_cancellation(const std::string& orderId, connection_hdl hdl);
@@ -50,6 +80,28 @@ private:
     std::function<std::string(OrderType, double, int, const std::string&, const std::string&)> m_submit_callback;
     std::function<bool(const std::string&)> m_cancel_callback;
 
+    // Broadcasts and connection changes, applied in order by the publisher thread
+    struct PublisherEvent {
+        enum Kind { OPEN, CLOSE, BROADCAST } kind;
+        connection_hdl hdl;
+        bool deflate;
+        DeflateParams params;
+        BroadcastClass messageClass;
+        std::string payload;
+    };
+    std::queue<PublisherEvent> m_publisher_queue;
+    std::mutex m_publisher_mutex;
+    std::condition_variable m_publisher_condition;
+    std::thread m_publisher_thread;
+    bool m_publisher_running;
+
+    // Owned by the publisher thread: each connection's compression group, 0 if
+    // it did not negotiate permessage-deflate
+    std::map<connection_hdl, DeflateGroups::GroupId, std::owner_less<connection_hdl>> m_groups;
+    DeflateGroups m_deflate_groups;
+    std::atomic<size_t> m_compressed_bytes;
+    std::atomic<size_t> m_uncompressed_bytes;
+
     // WebSocket event handlers
     void on_open(connection_hdl hdl);
     void on_close(connection_hdl hdl);
@@ -60,6 +112,11 @@ private:
     void process_message(const std::string& message, connection_hdl hdl);
     void send_message(connection_hdl hdl, const json& message);
     void send_error(connection_hdl hdl, const std::string& error);
+    void broadcast(BroadcastClass messageClass, const json& message);
+    void enqueue(PublisherEvent event);
+    void publisher_worker();
+    void publish(BroadcastClass messageClass, const std::string& payload);
+    message_ptr make_frame(server::connection_ptr con, const std::string& payload, bool compressed);
 
     // Helper functions
     OrderType string_to_order_type(const std::string& type);